@@ -0,0 +1,101 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+// Fixed set of worker threads that all run the same task together.
+// RunOnAll(task) calls task(t) once for every t in [0, GetNumThreads())
+// and returns when all of them are done. The calling thread is thread 0.
+// Shared by the Djikstra's and Huffman programs.
+class ThreadPool{
+    private:
+        int numThreads;
+        vector<thread> workers;
+        mutex lock;
+        condition_variable start;
+        condition_variable finished;
+        const function<void(int)>* task;
+        long long generation;
+        int running;
+        bool stopping;
+
+        void WorkerLoop(int id){
+            long long seen=0;
+            while(true){
+                const function<void(int)>* current;
+                {
+                    unique_lock<mutex> guard(lock);
+                    start.wait(guard,[&]{ return stopping || generation!=seen; });
+                    if(stopping){
+                        return;
+                    }
+                    seen=generation;
+                    current=task;
+                }
+                (*current)(id);
+                {
+                    lock_guard<mutex> guard(lock);
+                    running--;
+                    if(running==0){
+                        finished.notify_one();
+                    }
+                }
+            }
+        }
+    public:
+        ThreadPool(int n){
+            numThreads=n<1 ? 1 : n;
+            task=nullptr;
+            generation=0;
+            running=0;
+            stopping=false;
+            for(int i=1;i<numThreads;i++){
+                workers.emplace_back(&ThreadPool::WorkerLoop,this,i);
+            }
+        }
+        ~ThreadPool(){
+            {
+                lock_guard<mutex> guard(lock);
+                stopping=true;
+            }
+            start.notify_all();
+            for(thread& t : workers){
+                t.join();
+            }
+        }
+        int GetNumThreads() const{
+            return numThreads;
+        }
+        void RunOnAll(const function<void(int)>& job){
+            if(numThreads>1){
+                lock_guard<mutex> guard(lock);
+                task=&job;
+                running=numThreads-1;
+                generation++;
+            }
+            start.notify_all();
+            job(0);
+            if(numThreads>1){
+                unique_lock<mutex> guard(lock);
+                finished.wait(guard,[&]{ return running==0; });
+            }
+        }
+        // Splits [0,count) into one contiguous slice per thread and calls
+        // body(thread, begin, end) for each slice
+        void ParallelFor(int count, const function<void(int,int,int)>& body){
+            RunOnAll([&](int t){
+                long long begin=(long long)count*t/numThreads;
+                long long end=(long long)count*(t+1)/numThreads;
+                if(begin<end){
+                    body(t,(int)begin,(int)end);
+                }
+            });
+        }
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef BATCHQUERY_H
+#define BATCHQUERY_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "PointToPoint.h"
+#include "../Common/ThreadPool.h"
+using namespace std;
+
+// One line of the query stream: "s t" asks for the s -> t distance, "s"
+// alone for a summary of the search from s (how many vertices it
+// reached and the distance to the farthest one), not every distance;
+// main --distances writes those for one source
+struct Query{
+    int source;
+    int target;
+};
+
+// For an "s" query distance is the farthest reached vertex's distance
+// and reached the vertex count; for "s t", the distance and the vertices
+// the bidirectional search settled
+struct QueryAnswer{
+    int distance;
+    int reached;
+};
+
+struct BatchReport{
+    int numQueries=0;
+    double seconds=0;
+    double queriesPerSecond=0;
+    double p50Millis=0;
+    double p99Millis=0;
+};
+
+// Answers a batch of queries against one loaded graph on a worker pool.
+// Each thread keeps its own scratch arrays, so after a thread's first
+// query no further allocation happens.
+class BatchQueryServer{
+    private:
+        struct ThreadScratch{
+            DijkstraWorkspace workspace;
+            unique_ptr<PointToPointSearch> pointToPoint;
+            PathResult path;
+        };
+
+        const CSRGraph& graph;
+        CSRGraph reversed;
+        ThreadPool& pool;
+        vector<ThreadScratch> scratch;
+
+        void Answer(ThreadScratch& s, const Query& q, QueryAnswer& answer){
+            if(q.target<0){
+                // Only the vertices the search reached are looked at, so
+                // the summary never walks the whole distance array
+                NullObserver observer;
+                Dijkstra(graph,q.source,s.workspace,observer);
+                answer.distance=0;
+                answer.reached=(int)s.workspace.GetTouched().size();
+                for(int v : s.workspace.GetTouched()){
+                    int d=s.workspace.GetDistance(v);
+                    if(d>answer.distance){
+                        answer.distance=d;
+                    }
+                }
+            }
+            else{
+                s.pointToPoint->BidirectionalDijkstra(q.source,q.target,s.path);
+                answer.distance=s.path.distance;
+                answer.reached=s.path.settledVertices;
+            }
+        }
+
+    public:
+        BatchQueryServer(const CSRGraph& g, ThreadPool& p) : graph(g), pool(p){
+            reversed=graph.Reversed();
+            scratch.resize(pool.GetNumThreads());
+            for(ThreadScratch& s : scratch){
+                s.pointToPoint.reset(new PointToPointSearch(graph,reversed));
+            }
+        }
+
+        // Reads queries until end of input. Blank lines are skipped, and
+        // so are lines that name a vertex outside the graph (a negative
+        // target included) or whose target is not a number. Only a line
+        // with no target at all is an all-distances query.
+        void ReadQueries(istream& input, vector<Query>& queries){
+            string line;
+            int n=graph.GetNumVertices();
+            while(getline(input,line)){
+                istringstream fields(line);
+                Query q;
+                if(!(fields>>q.source)){
+                    continue;
+                }
+                q.target=-1;
+                if(!(fields>>ws).eof() && (!(fields>>q.target) || q.target<0)){
+                    cerr << "Skipping query with bad target: " << line << endl;
+                    continue;
+                }
+                if(q.source<0 || q.source>=n || q.target>=n){
+                    cerr << "Skipping query with unknown vertex: " << line << endl;
+                    continue;
+                }
+                queries.push_back(q);
+            }
+        }
+
+        // Fills answers in query order. Threads take the next unanswered
+        // query from a shared counter, so long queries do not hold up a slice.
+        BatchReport Run(const vector<Query>& queries, vector<QueryAnswer>& answers){
+            int count=(int)queries.size();
+            answers.resize(count);
+            vector<double> latency(count);
+            atomic<int> next(0);
+
+            auto begin=chrono::steady_clock::now();
+            pool.RunOnAll([&](int t){
+                ThreadScratch& s=scratch[t];
+                while(true){
+                    int i=next.fetch_add(1);
+                    if(i>=count){
+                        break;
+                    }
+                    auto start=chrono::steady_clock::now();
+                    Answer(s,queries[i],answers[i]);
+                    latency[i]=chrono::duration<double,milli>(chrono::steady_clock::now()-start).count();
+                }
+            });
+
+            BatchReport report;
+            report.numQueries=count;
+            report.seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+            if(count>0){
+                report.queriesPerSecond=count/report.seconds;
+                int p50=(int)(0.50*(count-1));
+                int p99=(int)(0.99*(count-1));
+                nth_element(latency.begin(),latency.begin()+p50,latency.end());
+                report.p50Millis=latency[p50];
+                nth_element(latency.begin(),latency.begin()+p99,latency.end());
+                report.p99Millis=latency[p99];
+            }
+            return report;
+        }
+
+        static void PrintAnswers(ostream& output, const vector<Query>& queries, const vector<QueryAnswer>& answers){
+            for(int i=0;i<(int)queries.size();i++){
+                output << queries[i].source;
+                if(queries[i].target>=0){
+                    output << " " << queries[i].target << " ";
+                    if(answers[i].distance==INF) output << "INF";
+                    else output << answers[i].distance;
+                }
+                else{
+                    output << " reached=" << answers[i].reached << " farthest=" << answers[i].distance;
+                }
+                output << "\n";
+            }
+        }
+
+        static void PrintReport(ostream& output, const BatchReport& report){
+            output << "Queries: " << report.numQueries << endl;
+            output << "Total time: " << fixed << setprecision(3) << report.seconds << " s" << endl;
+            output << "Throughput: " << fixed << setprecision(1) << report.queriesPerSecond << " queries/s" << endl;
+            output << "Latency p50: " << fixed << setprecision(3) << report.p50Millis << " ms" << endl;
+            output << "Latency p99: " << fixed << setprecision(3) << report.p99Millis << " ms" << endl;
+        }
+};
+
+#endif
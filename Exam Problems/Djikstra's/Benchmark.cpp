@@ -0,0 +1,524 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "Graph.h"
+#include "DeltaStepping.h"
+#include "PointToPoint.h"
+#include "ContractionHierarchy.h"
+#include "DenseDijkstra.h"
+#include "DynamicSSSP.h"
+#include "GraphGenerators.h"
+using namespace std;
+
+// Dijkstra with the old PQueue: improved vertices are enqueued again and
+// stale entries are skipped through the visited check
+vector<int> LazyDijkstra(const CSRGraph& graph, int start, long long& heapOps){
+    int n=graph.GetNumVertices();
+    vector<Vertex> vertices(n);
+    vector<bool> visited(n,false);
+    for(int i=0;i<n;i++){
+        vertices[i].vertexNum=i;
+        vertices[i].distance=INF;
+        vertices[i].predV=nullptr;
+    }
+    PQueue unvisited;
+    vertices[start].distance=0;
+    unvisited.Enqueue(&vertices[start]);
+    heapOps++;
+    while(!unvisited.IsEmpty()){
+        Vertex* currentV=unvisited.Dequeue();
+        heapOps++;
+        int u=currentV->vertexNum;
+        if(visited[u]){
+            continue;
+        }
+        visited[u]=true;
+        for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+            int v=graph.targets[e];
+            int alt=currentV->distance+graph.weights[e];
+            if(!visited[v] && alt<vertices[v].distance){
+                vertices[v].distance=alt;
+                vertices[v].predV=currentV;
+                unvisited.Enqueue(&vertices[v]);
+                heapOps++;
+            }
+        }
+    }
+    vector<int> dist(n);
+    for(int i=0;i<n;i++){
+        dist[i]=vertices[i].distance;
+    }
+    return dist;
+}
+
+template<int D>
+vector<int> IndexedDijkstra(const CSRGraph& graph, int start, IndexedDHeap<D>& heap, long long& heapOps){
+    int n=graph.GetNumVertices();
+    vector<int> dist(n,INF);
+    vector<bool> visited(n,false);
+    heap.Reset(n);
+    dist[start]=0;
+    heap.Push(start,0);
+    heapOps++;
+    while(!heap.IsEmpty()){
+        int u=heap.Pop();
+        heapOps++;
+        visited[u]=true;
+        for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+            int v=graph.targets[e];
+            int alt=dist[u]+graph.weights[e];
+            if(!visited[v] && alt<dist[v]){
+                dist[v]=alt;
+                heap.PushOrDecrease(v,alt);
+                heapOps++;
+            }
+        }
+    }
+    return dist;
+}
+
+double Seconds(chrono::steady_clock::time_point begin){
+    return chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+}
+
+template<int D>
+void RunIndexed(const string& name, const CSRGraph& graph, const vector<int>& sources, const vector<vector<int>>& expected){
+    IndexedDHeap<D> heap;
+    long long heapOps=0;
+    bool same=true;
+    auto begin=chrono::steady_clock::now();
+    for(int i=0;i<(int)sources.size();i++){
+        if(IndexedDijkstra<D>(graph,sources[i],heap,heapOps)!=expected[i]){
+            same=false;
+        }
+    }
+    double t=Seconds(begin)/sources.size();
+    cout << "  " << left << setw(20) << name << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms"
+         << setw(14) << heapOps/(long long)sources.size() << " ops" << (same ? "" : "  MISMATCH") << endl;
+}
+
+void RunDeltaStepping(const CSRGraph& graph, const vector<int>& sources, ThreadPool& pool, int delta){
+    if(delta<=0){
+        delta=DeltaStepping::DefaultDelta(graph);
+    }
+    DeltaStepping solver(graph,pool,delta);
+    ShortestPathTree expected;
+    ShortestPathTree actual;
+    bool same=true;
+    double t=0;
+    for(int source : sources){
+        Dijkstra(graph,source,expected);
+        auto begin=chrono::steady_clock::now();
+        solver.Run(source,actual);
+        t+=Seconds(begin);
+        if(!VerifyShortestPaths(graph,expected,actual)){
+            same=false;
+        }
+    }
+    t/=sources.size();
+    string name="Delta-stepping T="+to_string(pool.GetNumThreads())+" d="+to_string(delta);
+    cout << "  " << left << setw(20) << name << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms"
+         << (same ? "  verified" : "  MISMATCH") << endl;
+}
+
+// Random source/target pairs: reports the average number of vertices each
+// method settles and checks every distance against full Dijkstra
+void RunPointToPoint(const CSRGraph& graph, int queries, const vector<double>* x, const vector<double>* y){
+    mt19937 rng(11);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    PointToPointSearch search(graph);
+    ShortestPathTree tree;
+    PathResult path;
+    long long fullSettled=0;
+    long long bidiSettled=0;
+    long long astarSettled=0;
+    double fullTime=0;
+    double bidiTime=0;
+    double astarTime=0;
+    bool same=true;
+    for(int q=0;q<queries;q++){
+        int s=vertexDist(rng);
+        int t=vertexDist(rng);
+        auto begin=chrono::steady_clock::now();
+        Dijkstra(graph,s,tree);
+        fullTime+=Seconds(begin);
+        for(int v=0;v<graph.GetNumVertices();v++){
+            if(tree.distance[v]!=INF){
+                fullSettled++;
+            }
+        }
+
+        begin=chrono::steady_clock::now();
+        search.BidirectionalDijkstra(s,t,path);
+        bidiTime+=Seconds(begin);
+        bidiSettled+=path.settledVertices;
+        if(path.distance!=tree.distance[t]){
+            same=false;
+        }
+
+        if(x!=nullptr){
+            EuclideanHeuristic h(*x,*y,1.0,t);
+            begin=chrono::steady_clock::now();
+            search.AStar(s,t,h,path);
+            astarTime+=Seconds(begin);
+            astarSettled+=path.settledVertices;
+            if(path.distance!=tree.distance[t]){
+                same=false;
+            }
+        }
+    }
+    cout << "  " << left << setw(20) << "Full Dijkstra" << right << setw(12) << fixed << setprecision(2) << fullTime/queries*1000 << " ms"
+         << setw(14) << fullSettled/queries << " settled" << endl;
+    cout << "  " << left << setw(20) << "Bidirectional" << right << setw(12) << fixed << setprecision(2) << bidiTime/queries*1000 << " ms"
+         << setw(14) << bidiSettled/queries << " settled" << (same ? "" : "  MISMATCH") << endl;
+    if(x!=nullptr){
+        cout << "  " << left << setw(20) << "A* (euclidean)" << right << setw(12) << fixed << setprecision(2) << astarTime/queries*1000 << " ms"
+             << setw(14) << astarSettled/queries << " settled" << (same ? "" : "  MISMATCH") << endl;
+    }
+}
+
+// Preprocessing cost, index size and query speed of a contraction
+// hierarchy against plain Dijkstra on random source/target pairs
+void RunContractionHierarchy(const CSRGraph& graph, int queries){
+    auto begin=chrono::steady_clock::now();
+    ContractionHierarchy ch;
+    ch.Build(graph);
+    double buildTime=Seconds(begin);
+    long long graphBytes=sizeof(int)*((long long)graph.GetNumVertices()+1+2LL*graph.GetNumEdges());
+    cout << "  Preprocessing       " << setw(12) << fixed << setprecision(2) << buildTime << " s" << endl;
+    cout << "  Shortcuts           " << setw(12) << ch.GetNumShortcuts() << endl;
+    cout << "  Index size          " << setw(12) << fixed << setprecision(2) << ch.IndexBytes()/1048576.0 << " MB"
+         << " (graph " << graphBytes/1048576.0 << " MB)" << endl;
+
+    mt19937 rng(13);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    vector<int> sources(queries);
+    vector<int> targets(queries);
+    for(int q=0;q<queries;q++){
+        sources[q]=vertexDist(rng);
+        targets[q]=vertexDist(rng);
+    }
+    ShortestPathTree tree;
+    DijkstraWorkspace workspace;
+    vector<int> expected(queries);
+    begin=chrono::steady_clock::now();
+    for(int q=0;q<queries;q++){
+        Dijkstra(graph,sources[q],tree,workspace);
+        expected[q]=tree.distance[targets[q]];
+    }
+    double dijkstraTime=Seconds(begin)/queries;
+
+    // Repeat the CH queries so the timer sees more than a few microseconds
+    const int repeat=100;
+    bool same=true;
+    long long settled=0;
+    begin=chrono::steady_clock::now();
+    for(int r=0;r<repeat;r++){
+        for(int q=0;q<queries;q++){
+            int count;
+            if(ch.Query(sources[q],targets[q],&count)!=expected[q]){
+                same=false;
+            }
+            settled+=count;
+        }
+    }
+    double chTime=Seconds(begin)/((double)queries*repeat);
+    cout << "  " << left << setw(20) << "Dijkstra" << right << setw(12) << fixed << setprecision(2) << dijkstraTime*1e6 << " us" << endl;
+    cout << "  " << left << setw(20) << "CH query" << right << setw(12) << fixed << setprecision(2) << chTime*1e6 << " us"
+         << setw(14) << settled/((long long)queries*repeat) << " settled" << (same ? "" : "  MISMATCH") << endl;
+    cout << "  Speedup             " << setw(12) << fixed << setprecision(1) << dijkstraTime/chTime << "x" << endl;
+}
+
+// Runs the silent solver with one queue type over all sources
+template<class Queue>
+void RunQueue(const string& name, const CSRGraph& graph, const vector<int>& sources, const vector<vector<int>>& expected,
+              BasicDijkstraWorkspace<Queue>& workspace){
+    ShortestPathTree tree;
+    bool same=true;
+    auto begin=chrono::steady_clock::now();
+    for(int i=0;i<(int)sources.size();i++){
+        Dijkstra(graph,sources[i],tree,workspace);
+        if(tree.distance!=expected[i]){
+            same=false;
+        }
+    }
+    double t=Seconds(begin)/sources.size();
+    cout << "  " << left << setw(20) << name << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms"
+         << (same ? "" : "  MISMATCH") << endl;
+}
+
+// Small integer weights: the radix heap and Dial's buckets against the
+// comparison heaps
+void RunBoundedWeights(const string& title, const CSRGraph& graph, int queries){
+    cout << title << ": V=" << graph.GetNumVertices() << " E=" << graph.GetNumEdges()
+         << " max weight=" << graph.MaxWeight() << endl;
+    mt19937 rng(17);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    vector<int> sources(queries);
+    vector<vector<int>> expected(queries);
+    for(int i=0;i<queries;i++){
+        sources[i]=vertexDist(rng);
+    }
+
+    long long heapOps=0;
+    auto begin=chrono::steady_clock::now();
+    for(int i=0;i<queries;i++){
+        expected[i]=LazyDijkstra(graph,sources[i],heapOps);
+    }
+    double t=Seconds(begin)/queries;
+    cout << "  " << left << setw(20) << "PQueue (lazy)" << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms" << endl;
+
+    // The lazy PQueue can be wrong (see RunAll), so reference answers
+    // come from the indexed heap
+    BasicDijkstraWorkspace<IndexedDHeap<2>> binary;
+    ShortestPathTree tree;
+    for(int i=0;i<queries;i++){
+        Dijkstra(graph,sources[i],tree,binary);
+        expected[i]=tree.distance;
+    }
+    RunQueue("IndexedDHeap d=2",graph,sources,expected,binary);
+    BasicDijkstraWorkspace<IndexedDHeap<4>> quaternary;
+    RunQueue("IndexedDHeap d=4",graph,sources,expected,quaternary);
+    BasicDijkstraWorkspace<RadixHeap> radix;
+    RunQueue("RadixHeap",graph,sources,expected,radix);
+    BasicDijkstraWorkspace<BucketQueue> buckets;
+    buckets.unvisited.SetMaxWeight(graph.MaxWeight());
+    RunQueue("BucketQueue",graph,sources,expected,buckets);
+}
+
+// Heap Dijkstra against the array solver on a graph with density edges
+// per vertex pair
+void RunDense(int n, double density, int queries){
+    CSRGraph graph=RandomGraph(n,(int)(density*n*n),1000,19);
+    cout << "Dense graph: V=" << graph.GetNumVertices() << " E=" << graph.GetNumEdges()
+         << (PreferDense(graph) ? " (auto: dense)" : " (auto: heap)") << endl;
+    DenseGraph matrix;
+    matrix.Build(graph);
+    DenseDijkstra dense;
+    ShortestPathTree expected;
+    ShortestPathTree actual;
+    DijkstraWorkspace workspace;
+    double heapTime=0;
+    double denseTime=0;
+    bool same=true;
+    for(int q=0;q<queries;q++){
+        int source=q*7919%n;
+        auto begin=chrono::steady_clock::now();
+        Dijkstra(graph,source,expected,workspace);
+        heapTime+=Seconds(begin);
+        begin=chrono::steady_clock::now();
+        dense.Run(matrix,source,actual);
+        denseTime+=Seconds(begin);
+        if(!VerifyShortestPaths(graph,expected,actual)){
+            same=false;
+        }
+    }
+    cout << "  " << left << setw(20) << "IndexedDHeap d=4" << right << setw(12) << fixed << setprecision(2) << heapTime/queries*1000 << " ms" << endl;
+    cout << "  " << left << setw(20) << "DenseDijkstra" << right << setw(12) << fixed << setprecision(2) << denseTime/queries*1000 << " ms"
+         << (same ? "" : "  MISMATCH") << endl;
+}
+
+// Random weight changes, insertions and deletions on a copy of graph: the
+// incremental repair against rerunning Dijkstra after every edit
+void RunDynamic(const string& title, const CSRGraph& graph, int updates){
+    int n=graph.GetNumVertices();
+    cout << title << ": V=" << n << " E=" << graph.GetNumEdges() << ", " << updates << " edits" << endl;
+    DynamicShortestPaths dynamic(graph);
+    dynamic.Compute(0);
+    mt19937 rng(23);
+    uniform_int_distribution<int> vertexDist(0,n-1);
+    uniform_int_distribution<int> weightDist(1,1000);
+    uniform_int_distribution<int> kindDist(0,9);
+    long long touched=0;
+    double repairTime=0;
+    for(int i=0;i<updates;i++){
+        int u=vertexDist(rng);
+        while(graph.Degree(u)==0){
+            u=vertexDist(rng);
+        }
+        int v=graph.targets[graph.EdgeBegin(u)+rng()%graph.Degree(u)];
+        int kind=kindDist(rng);
+        auto begin=chrono::steady_clock::now();
+        if(kind==0){
+            dynamic.DeleteEdge(u,v);
+        }
+        else if(kind==1){
+            dynamic.InsertEdge(u,vertexDist(rng),weightDist(rng));
+        }
+        else if(!dynamic.UpdateEdge(u,v,weightDist(rng))){
+            dynamic.InsertEdge(u,v,weightDist(rng));
+        }
+        repairTime+=Seconds(begin);
+        touched+=dynamic.GetLastTouched();
+    }
+
+    CSRGraph edited=dynamic.ToCSR();
+    ShortestPathTree expected;
+    DijkstraWorkspace workspace;
+    auto begin=chrono::steady_clock::now();
+    Dijkstra(edited,0,expected,workspace);
+    double fullTime=Seconds(begin);
+    bool same=VerifyShortestPaths(edited,expected,dynamic.GetTree());
+    cout << "  " << left << setw(20) << "Full rerun" << right << setw(12) << fixed << setprecision(2) << fullTime*1e6 << " us"
+         << setw(14) << n << " settled" << endl;
+    cout << "  " << left << setw(20) << "Incremental repair" << right << setw(12) << fixed << setprecision(2) << repairTime/updates*1e6 << " us"
+         << setw(14) << touched/updates << " touched" << (same ? "" : "  MISMATCH") << endl;
+}
+
+// Copy of graph with the weights stored as Weight
+template<class Weight>
+BasicCSRGraph<Weight> WithWeights(const CSRGraph& graph){
+    vector<int> src;
+    vector<int> dst;
+    vector<Weight> w;
+    for(int u=0;u<graph.GetNumVertices();u++){
+        for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+            src.push_back(u);
+            dst.push_back(graph.targets[e]);
+            w.push_back((Weight)graph.weights[e]);
+        }
+    }
+    BasicCSRGraph<Weight> wide;
+    wide.Build(graph.GetNumVertices(),src,dst,w);
+    return wide;
+}
+
+// The same graph and queries with each weight width. The edge arrays grow
+// by 4 bytes per edge from 32 to 64 bits, and so does every distance and
+// heap key the search touches.
+template<class Weight>
+void RunWeightWidth(const string& name, const CSRGraph& graph, const vector<int>& sources, const vector<vector<int>>& expected){
+    BasicCSRGraph<Weight> wide=WithWeights<Weight>(graph);
+    long long bytes=(long long)sizeof(int)*(wide.GetNumVertices()+1+wide.GetNumEdges())+(long long)sizeof(Weight)*wide.GetNumEdges();
+    WeightedDijkstraWorkspace<Weight> workspace;
+    BasicShortestPathTree<Weight> tree;
+    bool same=true;
+    auto begin=chrono::steady_clock::now();
+    for(int i=0;i<(int)sources.size();i++){
+        Dijkstra(wide,sources[i],tree,workspace);
+        for(int v=0;v<wide.GetNumVertices();v++){
+            bool unreachable=tree.distance[v]==WeightTraits<Weight>::Infinity();
+            if(unreachable!=(expected[i][v]==INF) || (!unreachable && tree.distance[v]!=(Weight)expected[i][v])){
+                same=false;
+            }
+        }
+    }
+    double t=Seconds(begin)/sources.size();
+    cout << "  " << left << setw(20) << name << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms"
+         << setw(10) << fixed << setprecision(1) << bytes/1048576.0 << " MB graph" << (same ? "" : "  MISMATCH") << endl;
+}
+
+void RunWeightWidths(const string& title, const CSRGraph& graph, int queries){
+    cout << title << ": V=" << graph.GetNumVertices() << " E=" << graph.GetNumEdges() << endl;
+    vector<int> sources(queries);
+    vector<vector<int>> expected(queries);
+    ShortestPathTree tree;
+    for(int i=0;i<queries;i++){
+        sources[i]=i*7919%graph.GetNumVertices();
+        Dijkstra(graph,sources[i],tree);
+        expected[i]=tree.distance;
+    }
+    RunWeightWidth<int>("int32",graph,sources,expected);
+    RunWeightWidth<long long>("int64",graph,sources,expected);
+    RunWeightWidth<float>("float",graph,sources,expected);
+    RunWeightWidth<double>("double",graph,sources,expected);
+}
+
+void RunAll(const string& title, const CSRGraph& graph, int queries, ThreadPool& pool, int delta){
+    cout << title << ": V=" << graph.GetNumVertices() << " E=" << graph.GetNumEdges() << endl;
+    mt19937 rng(7);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    vector<int> sources(queries);
+    for(int i=0;i<queries;i++){
+        sources[i]=vertexDist(rng);
+    }
+
+    // Reference answers. The old PQueue changes a queued vertex's distance
+    // in place without re-heapifying, so it can return wrong distances.
+    vector<vector<int>> expected(queries);
+    IndexedDHeap<4> heap;
+    long long refOps=0;
+    for(int i=0;i<queries;i++){
+        expected[i]=IndexedDijkstra<4>(graph,sources[i],heap,refOps);
+    }
+
+    long long heapOps=0;
+    bool same=true;
+    auto begin=chrono::steady_clock::now();
+    for(int i=0;i<queries;i++){
+        if(LazyDijkstra(graph,sources[i],heapOps)!=expected[i]){
+            same=false;
+        }
+    }
+    double t=Seconds(begin)/queries;
+    cout << "  " << left << setw(20) << "PQueue (lazy)" << right << setw(12) << fixed << setprecision(2) << t*1000 << " ms"
+         << setw(14) << heapOps/queries << " ops" << (same ? "" : "  MISMATCH") << endl;
+
+    RunIndexed<2>("IndexedDHeap d=2",graph,sources,expected);
+    RunIndexed<4>("IndexedDHeap d=4",graph,sources,expected);
+    RunIndexed<8>("IndexedDHeap d=8",graph,sources,expected);
+    RunDeltaStepping(graph,sources,pool,delta);
+}
+
+// Usage: Benchmark [vertices] [queries] [threads] [delta]
+int main(int argc, char* argv[]){
+    int n=1000000;
+    int queries=5;
+    int threads=thread::hardware_concurrency();
+    int delta=0;
+    if(argc>1){
+        n=atoi(argv[1]);
+    }
+    if(argc>2){
+        queries=atoi(argv[2]);
+    }
+    if(argc>3){
+        threads=atoi(argv[3]);
+    }
+    if(argc>4){
+        delta=atoi(argv[4]);
+    }
+    ThreadPool pool(threads);
+    RunAll("Random graph (avg degree 8)",RandomGraph(n,8*n,1000,1),queries,pool,delta);
+    int side=1;
+    while((side+1)*(side+1)<=n){
+        side++;
+    }
+    CSRGraph grid=GridGraph(side,side,1000,2);
+    RunAll("Grid graph",grid,queries,pool,delta);
+
+    // Grid vertices sit at integer coordinates and every edge weighs at
+    // least 1, so the straight-line distance is an admissible heuristic
+    vector<double> x(side*side);
+    vector<double> y(side*side);
+    for(int v=0;v<side*side;v++){
+        x[v]=v%side;
+        y[v]=v/side;
+    }
+    cout << "Point-to-point, random graph" << endl;
+    RunPointToPoint(RandomGraph(n,8*n,1000,1),queries,nullptr,nullptr);
+    cout << "Point-to-point, grid graph" << endl;
+    RunPointToPoint(grid,queries,&x,&y);
+
+    RunBoundedWeights("Random graph, weights 1..16",RandomGraph(n,8*n,16,3),queries);
+    RunBoundedWeights("Grid graph, weights 1..16",GridGraph(side,side,16,4),queries);
+
+    RunDense(4000,0.5,queries);
+
+    RunWeightWidths("Weight widths, random graph",RandomGraph(n,8*n,1000,1),queries);
+    RunWeightWidths("Weight widths, grid graph",grid,queries);
+
+    RunDynamic("Dynamic updates, grid graph",grid,1000);
+    RunDynamic("Dynamic updates, random graph",RandomGraph(n,8*n,1000,1),1000);
+
+    // Contraction on random graphs produces huge numbers of shortcuts, so
+    // the hierarchy is only built for the road-like grid, capped at about
+    // 100k vertices to keep preprocessing within a minute or two
+    int chSide=side<316 ? side : 316;
+    cout << "Contraction hierarchy, " << chSide << "x" << chSide << " grid graph" << endl;
+    RunContractionHierarchy(chSide==side ? grid : GridGraph(chSide,chSide,1000,2),queries);
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "DeltaStepping.h"
+#include "PointToPoint.h"
+#include "../Common/ThreadPool.h"
+#include "GraphGenerators.h"
+#include "PartitionedSSSP.h"
+using namespace std;
+
+// One row of the report: one solver mode on one generated graph. The
+// per-query counters are -1 when the mode does not count them.
+// peakRssKb is the suite process's high-water mark while that mode ran,
+// counting what the process already held, such as the graph, or -1
+// where it cannot be measured.
+struct SuiteRecord{
+    string family;
+    string mode;
+    int vertices=0;
+    int edges=0;
+    double generateSeconds=0;
+    double loadSeconds=0;
+    int runs=0;
+    double meanMillis=0;
+    double minMillis=0;
+    long long heapOps=-1;
+    long long edgesRelaxed=-1;
+    long long settled=-1;
+    long peakRssKb=-1;
+    bool verified=true;
+};
+
+struct SuiteOptions{
+    vector<string> families;
+    long long edges=1000000;
+    int queries=5;
+    int repeat=3;
+    int threads=1;
+    int processes=0;
+    string csvFile;
+    string jsonFile;
+    string dir=".";
+};
+
+double Seconds(chrono::steady_clock::time_point begin){
+    return chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+}
+
+// Lowers the process's peak resident set to what it holds now, so the
+// next PeakRssKb covers one mode only. Needs Linux's /proc; returns
+// false elsewhere.
+bool ResetPeakRss(){
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+}
+
+// Peak resident set in KB since the last ResetPeakRss, from VmHWM in
+// /proc/self/status, or -1 if it cannot be read
+long PeakRssKb(){
+    ifstream status("/proc/self/status");
+    string line;
+    while(getline(status,line)){
+        if(line.compare(0,6,"VmHWM:")==0){
+            return atol(line.c_str()+6);
+        }
+    }
+    return -1;
+}
+
+// Builds the named family with about the requested number of edges
+bool Generate(const string& family, long long edges, CSRGraph& graph){
+    if(family=="grid"){
+        int side=1;
+        while(4LL*(side+1)*(side+1)<=edges){
+            side++;
+        }
+        graph=GridGraph(side,side,1000,2);
+    }
+    else if(family=="er"){
+        graph=RandomGraph((int)max(1LL,edges/8),(int)edges,1000,1);
+    }
+    else if(family=="rmat"){
+        int scale=1;
+        while((1LL<<scale)*16<edges){
+            scale++;
+        }
+        graph=RMatGraph(scale,(int)edges,1000,5);
+    }
+    else if(family=="chain"){
+        graph=ChainGraph((int)(edges/2+1),1000,6);
+    }
+    else{
+        return false;
+    }
+    return true;
+}
+
+// Times one Dijkstra queue over every source, repeat times, counting the
+// work and checking the distances against expected
+template<class Queue>
+void RunCounted(SuiteRecord& record, const CSRGraph& graph, BasicDijkstraWorkspace<Queue>& workspace,
+                const vector<int>& sources, int repeat, vector<vector<int>>* expected){
+    ShortestPathTree tree;
+    double total=0;
+    double best=1e300;
+    CountingObserver counts;
+    for(int r=0;r<repeat;r++){
+        for(int i=0;i<(int)sources.size();i++){
+            auto begin=chrono::steady_clock::now();
+            Dijkstra(graph,sources[i],tree,workspace,counts);
+            double t=Seconds(begin);
+            total+=t;
+            best=min(best,t);
+            if(expected->size()<sources.size()){
+                expected->push_back(tree.distance);
+            }
+            else if(tree.distance!=(*expected)[i]){
+                record.verified=false;
+            }
+        }
+    }
+    record.runs=repeat*(int)sources.size();
+    record.meanMillis=total/record.runs*1000;
+    record.minMillis=best*1000;
+    record.heapOps=counts.HeapOperations()/record.runs;
+    record.edgesRelaxed=counts.relaxed/record.runs;
+    record.settled=counts.settled/record.runs;
+}
+
+void RunDelta(SuiteRecord& record, const CSRGraph& graph, ThreadPool& pool, const vector<int>& sources,
+              int repeat, const vector<vector<int>>& expected){
+    DeltaStepping solver(graph,pool,DeltaStepping::DefaultDelta(graph));
+    ShortestPathTree tree;
+    double total=0;
+    double best=1e300;
+    for(int r=0;r<repeat;r++){
+        for(int i=0;i<(int)sources.size();i++){
+            auto begin=chrono::steady_clock::now();
+            solver.Run(sources[i],tree);
+            double t=Seconds(begin);
+            total+=t;
+            best=min(best,t);
+            if(tree.distance!=expected[i]){
+                record.verified=false;
+            }
+        }
+    }
+    record.runs=repeat*(int)sources.size();
+    record.meanMillis=total/record.runs*1000;
+    record.minMillis=best*1000;
+}
+
+// Point-to-point from each source to a random target
+void RunBidirectional(SuiteRecord& record, const CSRGraph& graph, const vector<int>& sources, int repeat,
+                      const vector<vector<int>>& expected){
+    PointToPointSearch search(graph);
+    PathResult path;
+    mt19937 rng(17);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    vector<int> targets(sources.size());
+    for(int& t : targets){
+        t=vertexDist(rng);
+    }
+    double total=0;
+    double best=1e300;
+    long long settled=0;
+    for(int r=0;r<repeat;r++){
+        for(int i=0;i<(int)sources.size();i++){
+            auto begin=chrono::steady_clock::now();
+            search.BidirectionalDijkstra(sources[i],targets[i],path);
+            double t=Seconds(begin);
+            total+=t;
+            best=min(best,t);
+            settled+=path.settledVertices;
+            if(path.distance!=expected[i][targets[i]]){
+                record.verified=false;
+            }
+        }
+    }
+    record.runs=repeat*(int)sources.size();
+    record.meanMillis=total/record.runs*1000;
+    record.minMillis=best*1000;
+    record.settled=settled/record.runs;
+}
+
+// Whole queries on the partitioned solver; each run forks its workers,
+// which load their ranges from file, so the time includes that start-up.
+// The row's peak RSS is the parent's only, not the workers'.
+void RunProcesses(SuiteRecord& record, const string& file, int processes, const vector<int>& sources,
+                  int repeat, const vector<vector<int>>& expected){
+    ShortestPathTree tree;
+    double total=0;
+    double best=1e300;
+    for(int r=0;r<repeat;r++){
+        for(int i=0;i<(int)sources.size();i++){
+            auto begin=chrono::steady_clock::now();
+            bool ok=RunPartitioned(file,sources[i],processes,tree);
+            double t=Seconds(begin);
+            total+=t;
+            best=min(best,t);
+            if(!ok || tree.distance!=expected[i]){
+                record.verified=false;
+            }
+        }
+    }
+    record.runs=repeat*(int)sources.size();
+    record.meanMillis=total/record.runs*1000;
+    record.minMillis=best*1000;
+}
+
+void PrintRecord(const SuiteRecord& r){
+    cout << "  " << left << setw(16) << r.mode << right
+         << setw(10) << fixed << setprecision(2) << r.meanMillis << " ms"
+         << setw(10) << fixed << setprecision(2) << r.minMillis << " ms min";
+    if(r.heapOps>=0) cout << setw(12) << r.heapOps << " heap ops";
+    if(r.edgesRelaxed>=0) cout << setw(12) << r.edgesRelaxed << " relaxed";
+    if(r.settled>=0) cout << setw(10) << r.settled << " settled";
+    if(r.peakRssKb>=0) cout << setw(10) << r.peakRssKb/1024 << " MB peak";
+    cout << (r.verified ? "" : "  MISMATCH") << endl;
+}
+
+// Generates, saves and maps one graph, then runs every mode on it. The
+// thread pool only lives for the delta-stepping row: the partitioned row
+// forks, which is only safe once those threads have been joined.
+void RunFamily(const string& family, const SuiteOptions& options, vector<SuiteRecord>& records){
+    auto begin=chrono::steady_clock::now();
+    CSRGraph generated;
+    if(!Generate(family,options.edges,generated)){
+        cerr << "Skipping unknown graph family " << family << endl;
+        return;
+    }
+    double generateSeconds=Seconds(begin);
+
+    // Time the path real runs take: a binary file mapped by Load
+    string file=options.dir+"/suite_"+family+".bin";
+    if(!generated.SaveBinary(file)){
+        cerr << "Error: Could not write " << file << endl;
+        return;
+    }
+    generated=CSRGraph();
+    CSRGraph graph;
+    begin=chrono::steady_clock::now();
+    if(!graph.Load(file)){
+        cerr << "Error: Could not load " << file << endl;
+        return;
+    }
+    double loadSeconds=Seconds(begin);
+    cout << family << ": V=" << graph.GetNumVertices() << " E=" << graph.GetNumEdges()
+         << " generate " << fixed << setprecision(2) << generateSeconds << " s, load "
+         << setprecision(4) << loadSeconds << " s" << endl;
+
+    mt19937 rng(7);
+    uniform_int_distribution<int> vertexDist(0,graph.GetNumVertices()-1);
+    vector<int> sources(options.queries);
+    for(int& s : sources){
+        s=vertexDist(rng);
+    }
+
+    SuiteRecord base;
+    base.family=family;
+    base.vertices=graph.GetNumVertices();
+    base.edges=graph.GetNumEdges();
+    base.generateSeconds=generateSeconds;
+    base.loadSeconds=loadSeconds;
+
+    // The first mode fills in the reference distances the others check
+    vector<vector<int>> expected;
+    SuiteRecord record=base;
+    record.mode="dijkstra-dheap";
+    bool measured=ResetPeakRss();
+    DijkstraWorkspace dheap;
+    RunCounted(record,graph,dheap,sources,options.repeat,&expected);
+    record.peakRssKb=measured ? PeakRssKb() : -1;
+    PrintRecord(record);
+    records.push_back(record);
+
+    record=base;
+    record.mode="dijkstra-radix";
+    measured=ResetPeakRss();
+    BasicDijkstraWorkspace<RadixHeap> radix;
+    RunCounted(record,graph,radix,sources,options.repeat,&expected);
+    record.peakRssKb=measured ? PeakRssKb() : -1;
+    PrintRecord(record);
+    records.push_back(record);
+
+    measured=ResetPeakRss();
+    BasicDijkstraWorkspace<BucketQueue> buckets;
+    if(buckets.unvisited.SetMaxWeight(graph.MaxWeight())){
+        record=base;
+        record.mode="dijkstra-bucket";
+        RunCounted(record,graph,buckets,sources,options.repeat,&expected);
+        record.peakRssKb=measured ? PeakRssKb() : -1;
+        PrintRecord(record);
+        records.push_back(record);
+    }
+
+    record=base;
+    record.mode="delta-stepping";
+    measured=ResetPeakRss();
+    {
+        ThreadPool pool(options.threads);
+        RunDelta(record,graph,pool,sources,options.repeat,expected);
+    }
+    record.peakRssKb=measured ? PeakRssKb() : -1;
+    PrintRecord(record);
+    records.push_back(record);
+
+    record=base;
+    record.mode="bidirectional";
+    measured=ResetPeakRss();
+    RunBidirectional(record,graph,sources,options.repeat,expected);
+    record.peakRssKb=measured ? PeakRssKb() : -1;
+    PrintRecord(record);
+    records.push_back(record);
+
+    if(options.processes>0){
+        record=base;
+        record.mode="partitioned-"+to_string(options.processes);
+        measured=ResetPeakRss();
+        RunProcesses(record,file,options.processes,sources,options.repeat,expected);
+        record.peakRssKb=measured ? PeakRssKb() : -1;
+        PrintRecord(record);
+        records.push_back(record);
+    }
+
+    remove(file.c_str());
+}
+
+bool WriteCsv(const string& filename, const vector<SuiteRecord>& records){
+    ofstream output(filename);
+    if(!output.is_open()){
+        return false;
+    }
+    output << "family,mode,vertices,edges,generate_s,load_s,runs,mean_ms,min_ms,heap_ops,edges_relaxed,settled,peak_rss_kb,verified\n";
+    for(const SuiteRecord& r : records){
+        output << r.family << "," << r.mode << "," << r.vertices << "," << r.edges << ","
+               << r.generateSeconds << "," << r.loadSeconds << "," << r.runs << ","
+               << r.meanMillis << "," << r.minMillis << ",";
+        if(r.heapOps>=0) output << r.heapOps;
+        output << ",";
+        if(r.edgesRelaxed>=0) output << r.edgesRelaxed;
+        output << ",";
+        if(r.settled>=0) output << r.settled;
+        output << ",";
+        if(r.peakRssKb>=0) output << r.peakRssKb;
+        output << "," << (r.verified ? "true" : "false") << "\n";
+    }
+    return (bool)output;
+}
+
+// Counters that were not measured are written as null
+void WriteJsonCount(ostream& output, const string& name, long long value){
+    output << ",\"" << name << "\":";
+    if(value>=0) output << value;
+    else output << "null";
+}
+
+bool WriteJson(const string& filename, const vector<SuiteRecord>& records){
+    ofstream output(filename);
+    if(!output.is_open()){
+        return false;
+    }
+    output << "{\"records\":[\n";
+    for(int i=0;i<(int)records.size();i++){
+        const SuiteRecord& r=records[i];
+        output << "  {\"family\":\"" << r.family << "\",\"mode\":\"" << r.mode << "\""
+               << ",\"vertices\":" << r.vertices << ",\"edges\":" << r.edges
+               << ",\"generate_s\":" << r.generateSeconds << ",\"load_s\":" << r.loadSeconds
+               << ",\"runs\":" << r.runs << ",\"mean_ms\":" << r.meanMillis << ",\"min_ms\":" << r.minMillis;
+        WriteJsonCount(output,"heap_ops",r.heapOps);
+        WriteJsonCount(output,"edges_relaxed",r.edgesRelaxed);
+        WriteJsonCount(output,"settled",r.settled);
+        WriteJsonCount(output,"peak_rss_kb",r.peakRssKb);
+        output << ",\"verified\":" << (r.verified ? "true" : "false") << "}";
+        output << (i+1<(int)records.size() ? ",\n" : "\n");
+    }
+    output << "]}\n";
+    return (bool)output;
+}
+
+// Usage: BenchmarkSuite [--family grid|er|rmat|chain|all] [--edges M]
+//                       [--queries Q] [--repeat R] [--threads T]
+//                       [--processes P] [--csv file] [--json file] [--dir path]
+// Each family is generated with about M edges (up to 10^8; building the
+// CSR needs roughly 25 bytes per edge), written to a binary file in dir,
+// mapped back, and every solver mode runs Q sources R times. With
+// --processes the partitioned solver is run on P processes as well.
+int main(int argc, char* argv[]){
+    SuiteOptions options;
+    options.threads=thread::hardware_concurrency();
+    string family="all";
+    for(int i=1;i+1<argc;i+=2){
+        string flag=argv[i];
+        string value=argv[i+1];
+        if(flag=="--family") family=value;
+        else if(flag=="--edges") options.edges=atoll(value.c_str());
+        else if(flag=="--queries") options.queries=atoi(value.c_str());
+        else if(flag=="--repeat") options.repeat=atoi(value.c_str());
+        else if(flag=="--threads") options.threads=atoi(value.c_str());
+        else if(flag=="--processes") options.processes=atoi(value.c_str());
+        else if(flag=="--csv") options.csvFile=value;
+        else if(flag=="--json") options.jsonFile=value;
+        else if(flag=="--dir") options.dir=value;
+        else{
+            cerr << "Unknown option " << flag << endl;
+            return 1;
+        }
+    }
+    if(options.edges<1 || options.edges>=INT_MAX || options.queries<1 || options.repeat<1){
+        cerr << "Error: edges, queries and repeat must be positive and edges below 2^31" << endl;
+        return 1;
+    }
+    if(options.threads<1){
+        options.threads=1;
+    }
+    if(family=="all"){
+        options.families={"grid","er","rmat","chain"};
+    }
+    else{
+        options.families={family};
+    }
+
+    vector<SuiteRecord> records;
+    for(const string& f : options.families){
+        RunFamily(f,options,records);
+    }
+    if(!options.csvFile.empty() && !WriteCsv(options.csvFile,records)){
+        cerr << "Error: Could not write " << options.csvFile << endl;
+        return 1;
+    }
+    if(!options.jsonFile.empty() && !WriteJson(options.jsonFile,records)){
+        cerr << "Error: Could not write " << options.jsonFile << endl;
+        return 1;
+    }
+    return 0;
+}
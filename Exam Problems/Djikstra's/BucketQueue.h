@@ -0,0 +1,133 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include <vector>
+#include "IndexedHeap.h"
+using namespace std;
+
+// Dial's bucket queue with decrease-key. current is the last popped key;
+// with edge weights at most C every queued key lies in [current,
+// current+C], so C+1 buckets indexed by key % (C+1) are reused
+// cyclically. Push and DecreaseKey are O(1); Pop scans forward to the
+// next non-empty bucket, which is O(C) worst case but amortized over the
+// distance range the search covers. C is limited to MAX_WEIGHT, since
+// the queue holds C+1 buckets whatever the graph size.
+class BucketQueue{
+    public:
+        static const int MAX_WEIGHT=1<<20;
+    private:
+        int size;
+        int maxWeight;
+        int numBuckets;
+        int current;
+        vector<vector<int>> buckets;
+        vector<int> key;
+        vector<int> pos;
+
+        void Insert(int v, int k){
+            vector<int>& bucket=buckets[k%numBuckets];
+            key[v]=k;
+            pos[v]=(int)bucket.size();
+            bucket.push_back(v);
+        }
+        // C+1 buckets, allocated when C changed since the last time
+        void Allocate(){
+            if(buckets.size()!=(size_t)((long long)maxWeight+1)){
+                numBuckets=maxWeight+1;
+                buckets.assign(numBuckets,vector<int>());
+            }
+        }
+        void Remove(int v){
+            vector<int>& bucket=buckets[key[v]%numBuckets];
+            int moved=bucket.back();
+            bucket[pos[v]]=moved;
+            pos[moved]=pos[v];
+            bucket.pop_back();
+        }
+    public:
+        typedef int KeyType;
+
+        BucketQueue(){
+            size=0;
+            maxWeight=1;
+            numBuckets=2;
+            current=0;
+            Allocate();
+        }
+        // Largest edge weight the search will see; call before Reset.
+        // Returns false and keeps the old C when c is above MAX_WEIGHT.
+        bool SetMaxWeight(int c){
+            if(c>MAX_WEIGHT){
+                return false;
+            }
+            maxWeight=c<1 ? 1 : c;
+            return true;
+        }
+        void Reset(int n){
+            size=0;
+            current=0;
+            Allocate();
+            for(vector<int>& bucket : buckets){
+                bucket.clear();
+            }
+            key.resize(n);
+            pos.assign(n,-1);
+        }
+        // Empties the queue without touching pos for every vertex. Queued
+        // entries are found by scanning the buckets, so this is O(C) plus
+        // the entries left, and free when the last search ran to the end.
+        void Clear(){
+            if(size>0){
+                for(vector<int>& bucket : buckets){
+                    for(int v : bucket){
+                        pos[v]=-1;
+                    }
+                    bucket.clear();
+                }
+            }
+            size=0;
+            current=0;
+            Allocate();
+        }
+        int GetSize() const{
+            return size;
+        }
+        bool IsEmpty() const{
+            return size==0;
+        }
+        bool Contains(int v) const{
+            return pos[v]>=0;
+        }
+        void Push(int v, int k){
+            Insert(v,k);
+            size++;
+        }
+        void DecreaseKey(int v, int k){
+            Remove(v);
+            Insert(v,k);
+        }
+        void PushOrDecrease(int v, int k){
+            if(pos[v]>=0){
+                DecreaseKey(v,k);
+            }
+            else{
+                Push(v,k);
+            }
+        }
+        int Pop(){
+            if(size==0){
+                throw QueueException("Queue Is Empty");
+            }
+            while(buckets[current%numBuckets].empty()){
+                current++;
+            }
+            vector<int>& bucket=buckets[current%numBuckets];
+            int v=bucket.back();
+            bucket.pop_back();
+            pos[v]=-1;
+            size--;
+            return v;
+        }
+};
+
+#endif
@@ -0,0 +1,388 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Layout of the binary CSR file: this header, then offsets[V+1] and
+// targets[E] as 32-bit ints, zero padding up to a multiple of weightBytes,
+// and weights[E]. 32-bit integer weights need no padding, so those files
+// look exactly as they did before wider weights existed.
+struct CSRFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint64_t numVertices;
+    uint64_t numEdges;
+    uint32_t weightBytes;
+    uint32_t weightKind;
+};
+
+const char CSR_MAGIC[4]={'C','S','R','G'};
+const uint32_t CSR_VERSION=1;
+const uint32_t CSR_INTEGER_WEIGHTS=0;
+const uint32_t CSR_FLOAT_WEIGHTS=1;
+
+// Compressed sparse row graph: the out-edges of vertex v are
+// targets[offsets[v]] .. targets[offsets[v+1]-1] with matching weights.
+// The arrays are either owned by the graph or point straight into a
+// memory-mapped binary file. Weight is int, long long, float or double;
+// CSRGraph (int weights) is what the rest of the solvers use.
+template<class Weight>
+class BasicCSRGraph{
+    public:
+        int numVertices=0;
+        int numEdges=0;
+        const int* offsets=nullptr;
+        const int* targets=nullptr;
+        const Weight* weights=nullptr;
+
+    private:
+        // Text weights are read this wide, then range checked
+        typedef typename conditional<is_floating_point<Weight>::value,double,long long>::type WideWeight;
+
+        vector<int> offsetStore;
+        vector<int> targetStore;
+        vector<Weight> weightStore;
+        shared_ptr<const char> mapping;
+
+        void PointAtStore(){
+            offsets=offsetStore.data();
+            targets=targetStore.data();
+            weights=weightStore.data();
+            numEdges=(int)targetStore.size();
+        }
+
+    public:
+        BasicCSRGraph(){}
+        BasicCSRGraph(const BasicCSRGraph& other){
+            *this=other;
+        }
+        BasicCSRGraph(BasicCSRGraph&& other)=default;
+        BasicCSRGraph& operator=(BasicCSRGraph&& other)=default;
+        BasicCSRGraph& operator=(const BasicCSRGraph& other){
+            if(this==&other){
+                return *this;
+            }
+            numVertices=other.numVertices;
+            numEdges=other.numEdges;
+            offsetStore=other.offsetStore;
+            targetStore=other.targetStore;
+            weightStore=other.weightStore;
+            mapping=other.mapping;
+            if(mapping){
+                offsets=other.offsets;
+                targets=other.targets;
+                weights=other.weights;
+            }
+            else{
+                PointAtStore();
+            }
+            return *this;
+        }
+
+        bool IsMapped() const{
+            return (bool)mapping;
+        }
+        int GetNumVertices() const{
+            return numVertices;
+        }
+        int GetNumEdges() const{
+            return numEdges;
+        }
+        int EdgeBegin(int v) const{
+            return offsets[v];
+        }
+        int EdgeEnd(int v) const{
+            return offsets[v+1];
+        }
+        int Degree(int v) const{
+            return offsets[v+1]-offsets[v];
+        }
+        // Largest edge weight, or 1 for a graph with no edges
+        Weight MaxWeight() const{
+            Weight maxWeight=1;
+            for(int e=0;e<numEdges;e++){
+                if(weights[e]>maxWeight){
+                    maxWeight=weights[e];
+                }
+            }
+            return maxWeight;
+        }
+
+        // Build from an edge list. Duplicate (a,b) pairs keep the last weight
+        // and weight 0 means "no edge", same as the old adjacency matrix did.
+        void Build(int size, const vector<int>& src, const vector<int>& dst, const vector<Weight>& w){
+            numVertices=size;
+            mapping.reset();
+            int m=(int)src.size();
+            vector<int> counts(size+1,0);
+            for(int i=0;i<m;i++){
+                counts[src[i]+1]++;
+            }
+            for(int v=0;v<size;v++){
+                counts[v+1]+=counts[v];
+            }
+
+            // Counting sort by source keeps file order inside each row
+            vector<int> order(m);
+            vector<int> next(counts.begin(),counts.end()-1);
+            for(int i=0;i<m;i++){
+                order[next[src[i]]++]=i;
+            }
+
+            targetStore.clear();
+            weightStore.clear();
+            targetStore.reserve(m);
+            weightStore.reserve(m);
+            offsetStore.assign(size+1,0);
+            for(int v=0;v<size;v++){
+                offsetStore[v]=(int)targetStore.size();
+                stable_sort(order.begin()+counts[v],order.begin()+counts[v+1],
+                    [&](int x, int y){ return dst[x]<dst[y]; });
+                for(int k=counts[v];k<counts[v+1];k++){
+                    int e=order[k];
+                    // Only the last occurrence of a target in this row counts
+                    if(k+1<counts[v+1] && dst[order[k+1]]==dst[e]){
+                        continue;
+                    }
+                    if(w[e]==0){
+                        continue;
+                    }
+                    targetStore.push_back(dst[e]);
+                    weightStore.push_back(w[e]);
+                }
+            }
+            offsetStore[size]=(int)targetStore.size();
+            PointAtStore();
+        }
+
+        // Same vertices with every edge turned around
+        BasicCSRGraph Reversed() const{
+            vector<int> src(numEdges);
+            vector<int> dst(numEdges);
+            vector<Weight> w(numEdges);
+            for(int u=0;u<numVertices;u++){
+                for(int e=offsets[u];e<offsets[u+1];e++){
+                    src[e]=targets[e];
+                    dst[e]=u;
+                    w[e]=weights[e];
+                }
+            }
+            BasicCSRGraph reversed;
+            reversed.Build(numVertices,src,dst,w);
+            return reversed;
+        }
+
+        // Reads the text format used by the exam files: vertex count
+        // followed by "a b weight" triples. Returns false on a bad file,
+        // including a negative weight or one that does not fit in Weight.
+        bool LoadEdgeList(string filename){
+            ifstream input(filename);
+            if(!input.is_open()){
+                return false;
+            }
+            int size;
+            if(!(input>>size) || size<0){
+                return false;
+            }
+            vector<int> src;
+            vector<int> dst;
+            vector<Weight> w;
+            int a;
+            int b;
+            WideWeight weight;
+            while(input>>a){
+                if(!(input>>b>>weight)){
+                    return false;
+                }
+                if(a<0 || a>=size || b<0 || b>=size){
+                    return false;
+                }
+                if(!(weight>=0) || weight>(WideWeight)numeric_limits<Weight>::max()){
+                    return false;
+                }
+                src.push_back(a);
+                dst.push_back(b);
+                w.push_back((Weight)weight);
+            }
+            input.close();
+            Build(size,src,dst,w);
+            return true;
+        }
+
+        // Writes the header and arrays of the binary CSR format
+        bool Write(ostream& output) const{
+            CSRFileHeader header;
+            memset(&header,0,sizeof(header));
+            memcpy(header.magic,CSR_MAGIC,4);
+            header.version=CSR_VERSION;
+            header.numVertices=numVertices;
+            header.numEdges=numEdges;
+            header.weightBytes=sizeof(Weight);
+            header.weightKind=WeightKind();
+            output.write((const char*)&header,sizeof(header));
+            output.write((const char*)offsets,sizeof(int)*(size_t)(numVertices+1));
+            output.write((const char*)targets,sizeof(int)*(size_t)numEdges);
+            static const char zeros[sizeof(Weight)]={};
+            output.write(zeros,Padding(numVertices,numEdges));
+            output.write((const char*)weights,sizeof(Weight)*(size_t)numEdges);
+            return (bool)output;
+        }
+
+        // Reads what Write wrote into owned storage
+        bool Read(istream& input){
+            CSRFileHeader header;
+            if(!input.read((char*)&header,sizeof(header)) || !ValidHeader(header)){
+                return false;
+            }
+            numVertices=(int)header.numVertices;
+            mapping.reset();
+            offsetStore.resize(numVertices+1);
+            targetStore.resize(header.numEdges);
+            weightStore.resize(header.numEdges);
+            input.read((char*)offsetStore.data(),sizeof(int)*offsetStore.size());
+            input.read((char*)targetStore.data(),sizeof(int)*targetStore.size());
+            input.ignore(Padding(header.numVertices,header.numEdges));
+            input.read((char*)weightStore.data(),sizeof(Weight)*weightStore.size());
+            PointAtStore();
+            return input && ValidArrays(numVertices,numEdges,offsets,targets,weights);
+        }
+
+        // Writes the binary CSR file that MapBinary reads
+        bool SaveBinary(string filename) const{
+            ofstream output(filename, ios::binary);
+            if(!output.is_open()){
+                return false;
+            }
+            return Write(output);
+        }
+
+        // Reads just the header, e.g. to see which weight type a file holds
+        static bool ReadHeader(string filename, CSRFileHeader& header){
+            ifstream input(filename, ios::binary);
+            return input.read((char*)&header,sizeof(header)) && memcmp(header.magic,CSR_MAGIC,4)==0;
+        }
+
+        static bool IsBinaryFile(string filename){
+            ifstream input(filename, ios::binary);
+            char magic[4];
+            if(!input.read(magic,4)){
+                return false;
+            }
+            return memcmp(magic,CSR_MAGIC,4)==0;
+        }
+
+        // Maps a binary CSR file and points the arrays into it. Nothing is
+        // parsed or copied, but offsets and targets are checked once, in
+        // O(V+E), since every solver indexes with them unchecked.
+        bool MapBinary(string filename){
+#ifdef _WIN32
+            // No mmap here, so read the arrays into owned storage instead
+            ifstream input(filename, ios::binary);
+            return input.is_open() && Read(input);
+#else
+            int fd=open(filename.c_str(),O_RDONLY);
+            if(fd<0){
+                return false;
+            }
+            struct stat info;
+            if(fstat(fd,&info)!=0 || (size_t)info.st_size<sizeof(CSRFileHeader)){
+                close(fd);
+                return false;
+            }
+            size_t length=info.st_size;
+            void* base=mmap(nullptr,length,PROT_READ,MAP_PRIVATE,fd,0);
+            close(fd);
+            if(base==MAP_FAILED){
+                return false;
+            }
+            shared_ptr<const char> region((const char*)base,[length](const char* p){
+                munmap((void*)p,length);
+            });
+            const CSRFileHeader* header=(const CSRFileHeader*)base;
+            if(!ValidHeader(*header)){
+                return false;
+            }
+            size_t weightStart=sizeof(CSRFileHeader)+sizeof(int)*(header->numVertices+1+header->numEdges)
+                +Padding(header->numVertices,header->numEdges);
+            if(length<weightStart+sizeof(Weight)*header->numEdges){
+                return false;
+            }
+            const int* data=(const int*)(region.get()+sizeof(CSRFileHeader));
+            if(!ValidArrays((int)header->numVertices,(int)header->numEdges,data,data+header->numVertices+1,
+                            (const Weight*)(region.get()+weightStart))){
+                return false;
+            }
+            offsetStore.clear();
+            targetStore.clear();
+            weightStore.clear();
+            mapping=region;
+            numVertices=(int)header->numVertices;
+            numEdges=(int)header->numEdges;
+            offsets=data;
+            targets=data+numVertices+1;
+            weights=(const Weight*)(region.get()+weightStart);
+            return true;
+#endif
+        }
+
+        // Binary file if it starts with the CSR magic, text edge list otherwise
+        bool Load(string filename){
+            if(IsBinaryFile(filename)){
+                return MapBinary(filename);
+            }
+            return LoadEdgeList(filename);
+        }
+
+    private:
+        static uint32_t WeightKind(){
+            return is_floating_point<Weight>::value ? CSR_FLOAT_WEIGHTS : CSR_INTEGER_WEIGHTS;
+        }
+        // Zero bytes between targets and weights so the weights are aligned
+        static size_t Padding(uint64_t numVertices, uint64_t numEdges){
+            size_t end=sizeof(CSRFileHeader)+sizeof(int)*(numVertices+1+numEdges);
+            return (sizeof(Weight)-end%sizeof(Weight))%sizeof(Weight);
+        }
+        // Offsets start at 0, never decrease and end at numEdges, every
+        // target is a vertex and no weight is negative (or NaN); a
+        // truncated or corrupt file fails here
+        static bool ValidArrays(int numVertices, int numEdges, const int* offsets, const int* targets, const Weight* weights){
+            if(offsets[0]!=0 || offsets[numVertices]!=numEdges){
+                return false;
+            }
+            for(int v=0;v<numVertices;v++){
+                if(offsets[v+1]<offsets[v]){
+                    return false;
+                }
+            }
+            for(int e=0;e<numEdges;e++){
+                if((unsigned)targets[e]>=(unsigned)numVertices || !(weights[e]>=0)){
+                    return false;
+                }
+            }
+            return true;
+        }
+        static bool ValidHeader(const CSRFileHeader& header){
+            return memcmp(header.magic,CSR_MAGIC,4)==0 && header.version==CSR_VERSION
+                && header.weightBytes==sizeof(Weight) && header.weightKind==WeightKind()
+                && header.numVertices<(uint64_t)INT32_MAX && header.numEdges<(uint64_t)INT32_MAX;
+        }
+};
+
+typedef BasicCSRGraph<int> CSRGraph;
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "IndexedHeap.h"
+using namespace std;
+
+const char CH_MAGIC[4]={'C','H','I','X'};
+const uint32_t CH_VERSION=1;
+
+// Contraction hierarchy (Geisberger et al.). Vertices are contracted one
+// at a time in order of importance. When a vertex is removed, a shortcut
+// u->x is added for every path u->v->x that has no equally short witness
+// path avoiding v. Every shortest path then climbs up the ranking and
+// comes back down, so a query is two small upward searches.
+class ContractionHierarchy{
+    private:
+        struct Arc{
+            int to;
+            int weight;
+        };
+
+        int numVertices=0;
+        long long numShortcuts=0;
+        vector<int> rank;
+        // up holds u->x with rank[x]>rank[u]. down holds, at x, every
+        // original-direction edge u->x with rank[u]>rank[x], stored as x->u.
+        CSRGraph up;
+        CSRGraph down;
+
+        // Preprocessing state
+        vector<vector<Arc>> out;
+        vector<vector<Arc>> in;
+        vector<char> contracted;
+        vector<int> deletedNeighbors;
+        vector<int> witnessDist;
+        vector<int> witnessStamp;
+        vector<int> targetStamp;
+        int witnessRound=0;
+        int targetRound=0;
+        IndexedDHeap<> witnessQueue;
+        vector<Arc> shortcutFrom;
+        vector<int> shortcutTo;
+
+        // Query state, reset in O(touched) through the stamps
+        vector<int> forwardDist;
+        vector<int> backwardDist;
+        vector<int> forwardStamp;
+        vector<int> backwardStamp;
+        int queryRound=0;
+        IndexedDHeap<> forwardQueue;
+        IndexedDHeap<> backwardQueue;
+
+        static const int WITNESS_LIMIT=500;
+        static const int SIMULATE_LIMIT=50;
+
+        static void AddOrLower(vector<Arc>& arcs, int to, int weight){
+            for(Arc& a : arcs){
+                if(a.to==to){
+                    if(weight<a.weight){
+                        a.weight=weight;
+                    }
+                    return;
+                }
+            }
+            arcs.push_back({to,weight});
+        }
+        static void RemoveArc(vector<Arc>& arcs, int to){
+            for(int i=0;i<(int)arcs.size();i++){
+                if(arcs[i].to==to){
+                    arcs[i]=arcs.back();
+                    arcs.pop_back();
+                    return;
+                }
+            }
+        }
+
+        int WitnessDistance(int v){
+            return witnessStamp[v]==witnessRound ? witnessDist[v] : INF;
+        }
+
+        // Bounded Dijkstra from source that never passes through skip. It
+        // stops early once all numTargets vertices marked in targetStamp
+        // have been settled.
+        void WitnessSearch(int source, int skip, int maxDistance, int limit, int numTargets){
+            witnessRound++;
+            witnessQueue.Clear();
+            witnessDist[source]=0;
+            witnessStamp[source]=witnessRound;
+            witnessQueue.Push(source,0);
+            int settled=0;
+            while(!witnessQueue.IsEmpty() && settled<limit){
+                if(witnessQueue.TopKey()>maxDistance){
+                    break;
+                }
+                int u=witnessQueue.Pop();
+                settled++;
+                if(targetStamp[u]==targetRound){
+                    numTargets--;
+                    if(numTargets==0){
+                        break;
+                    }
+                }
+                for(const Arc& a : out[u]){
+                    if(a.to==skip || contracted[a.to]){
+                        continue;
+                    }
+                    bool saturated=false;
+                    int alt=WeightTraits<int>::Add(witnessDist[u],a.weight,saturated);
+                    if(alt<WitnessDistance(a.to)){
+                        witnessDist[a.to]=alt;
+                        witnessStamp[a.to]=witnessRound;
+                        witnessQueue.PushOrDecrease(a.to,alt);
+                    }
+                }
+            }
+        }
+
+        // Finds the shortcuts contracting v needs; they are left in
+        // shortcutFrom/shortcutTo and their count is returned
+        int FindShortcuts(int v, int limit){
+            shortcutFrom.clear();
+            shortcutTo.clear();
+            int maxOut=0;
+            targetRound++;
+            for(const Arc& a : out[v]){
+                if(a.weight>maxOut){
+                    maxOut=a.weight;
+                }
+                targetStamp[a.to]=targetRound;
+            }
+            // Sums saturate at INF; a path through v that long is no
+            // shorter than "unreachable", so it needs no shortcut
+            bool saturated=false;
+            for(const Arc& inArc : in[v]){
+                int u=inArc.to;
+                WitnessSearch(u,v,WeightTraits<int>::Add(inArc.weight,maxOut,saturated),limit,(int)out[v].size());
+                for(const Arc& outArc : out[v]){
+                    int x=outArc.to;
+                    if(x==u){
+                        continue;
+                    }
+                    int viaV=WeightTraits<int>::Add(inArc.weight,outArc.weight,saturated);
+                    if(viaV!=INF && WitnessDistance(x)>viaV){
+                        shortcutFrom.push_back({u,viaV});
+                        shortcutTo.push_back(x);
+                    }
+                }
+            }
+            return (int)shortcutTo.size();
+        }
+
+        // Edge difference, weighted up, plus the number of already
+        // contracted neighbours, which spreads contraction over the graph
+        int Priority(int v){
+            int shortcuts=FindShortcuts(v,SIMULATE_LIMIT);
+            int removed=(int)(in[v].size()+out[v].size());
+            return 4*(shortcuts-removed)+deletedNeighbors[v];
+        }
+
+        void Contract(int v, vector<int>& upSrc, vector<int>& upDst, vector<int>& upW,
+                      vector<int>& downSrc, vector<int>& downDst, vector<int>& downW){
+            FindShortcuts(v,WITNESS_LIMIT);
+            for(const Arc& a : out[v]){
+                upSrc.push_back(v);
+                upDst.push_back(a.to);
+                upW.push_back(a.weight);
+                RemoveArc(in[a.to],v);
+                deletedNeighbors[a.to]++;
+            }
+            for(const Arc& a : in[v]){
+                downSrc.push_back(v);
+                downDst.push_back(a.to);
+                downW.push_back(a.weight);
+                RemoveArc(out[a.to],v);
+                deletedNeighbors[a.to]++;
+            }
+            for(int i=0;i<(int)shortcutTo.size();i++){
+                int u=shortcutFrom[i].to;
+                int x=shortcutTo[i];
+                AddOrLower(out[u],x,shortcutFrom[i].weight);
+                AddOrLower(in[x],u,shortcutFrom[i].weight);
+            }
+            numShortcuts+=shortcutTo.size();
+            contracted[v]=1;
+        }
+
+        void PrepareQuery(){
+            forwardDist.assign(numVertices,INF);
+            backwardDist.assign(numVertices,INF);
+            forwardStamp.assign(numVertices,0);
+            backwardStamp.assign(numVertices,0);
+            queryRound=0;
+            forwardQueue.Reset(numVertices);
+            backwardQueue.Reset(numVertices);
+        }
+
+        // Settles one vertex of an upward search and relaxes its edges. The
+        // meeting sum is taken in 64 bits and best never exceeds INF.
+        void UpwardStep(const CSRGraph& graph, IndexedDHeap<>& queue, vector<int>& dist, vector<int>& stamp,
+                        const vector<int>& otherDist, const vector<int>& otherStamp, long long& best){
+            int u=queue.Pop();
+            if(otherStamp[u]==queryRound && (long long)dist[u]+otherDist[u]<best){
+                best=(long long)dist[u]+otherDist[u];
+            }
+            for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                int v=graph.targets[e];
+                bool saturated=false;
+                int alt=WeightTraits<int>::Add(dist[u],graph.weights[e],saturated);
+                if(alt<(stamp[v]==queryRound ? dist[v] : INF)){
+                    dist[v]=alt;
+                    stamp[v]=queryRound;
+                    queue.PushOrDecrease(v,alt);
+                }
+            }
+        }
+
+    public:
+        int GetNumVertices() const{
+            return numVertices;
+        }
+        long long GetNumShortcuts() const{
+            return numShortcuts;
+        }
+        int GetRank(int v) const{
+            return rank[v];
+        }
+        // Bytes taken by the rank array and the two upward graphs
+        long long IndexBytes() const{
+            return sizeof(int)*((long long)numVertices
+                + 2*(numVertices+1) + 2LL*up.GetNumEdges() + 2LL*down.GetNumEdges());
+        }
+
+        void Build(const CSRGraph& graph){
+            numVertices=graph.GetNumVertices();
+            numShortcuts=0;
+            out.assign(numVertices,vector<Arc>());
+            in.assign(numVertices,vector<Arc>());
+            for(int u=0;u<numVertices;u++){
+                for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                    int v=graph.targets[e];
+                    if(v!=u){
+                        AddOrLower(out[u],v,graph.weights[e]);
+                        AddOrLower(in[v],u,graph.weights[e]);
+                    }
+                }
+            }
+            contracted.assign(numVertices,0);
+            deletedNeighbors.assign(numVertices,0);
+            witnessDist.assign(numVertices,INF);
+            witnessStamp.assign(numVertices,0);
+            targetStamp.assign(numVertices,0);
+            witnessRound=0;
+            targetRound=0;
+            witnessQueue.Reset(numVertices);
+            rank.assign(numVertices,-1);
+
+            IndexedDHeap<> order;
+            order.Reset(numVertices);
+            for(int v=0;v<numVertices;v++){
+                order.Push(v,Priority(v));
+            }
+
+            vector<int> upSrc, upDst, upW, downSrc, downDst, downW;
+            int nextRank=0;
+            while(!order.IsEmpty()){
+                // Lazy update: a stale priority is recomputed and the vertex
+                // only goes ahead if it is still the smallest
+                int v=order.Pop();
+                int priority=Priority(v);
+                if(!order.IsEmpty() && priority>order.TopKey()){
+                    order.Push(v,priority);
+                    continue;
+                }
+                rank[v]=nextRank++;
+                Contract(v,upSrc,upDst,upW,downSrc,downDst,downW);
+                // Neighbours only get the deleted-neighbour term bumped here;
+                // recomputing their edge difference too would run witness
+                // searches for every neighbour, which is far too slow once
+                // degrees grow. The lazy check above catches the rest.
+                for(const Arc& a : out[v]){
+                    order.ChangeKey(a.to,order.GetKey(a.to)+1);
+                }
+                for(const Arc& a : in[v]){
+                    order.ChangeKey(a.to,order.GetKey(a.to)+1);
+                }
+                vector<Arc>().swap(out[v]);
+                vector<Arc>().swap(in[v]);
+            }
+            up.Build(numVertices,upSrc,upDst,upW);
+            down.Build(numVertices,downSrc,downDst,downW);
+
+            vector<vector<Arc>>().swap(out);
+            vector<vector<Arc>>().swap(in);
+            vector<int>().swap(witnessDist);
+            vector<int>().swap(witnessStamp);
+            vector<int>().swap(targetStamp);
+            PrepareQuery();
+        }
+
+        // Distance from source to target, INF if unreachable. settled, if
+        // given, receives the number of vertices both searches popped.
+        int Query(int source, int target, int* settled=nullptr){
+            queryRound++;
+            forwardQueue.Clear();
+            backwardQueue.Clear();
+            forwardDist[source]=0;
+            forwardStamp[source]=queryRound;
+            backwardDist[target]=0;
+            backwardStamp[target]=queryRound;
+            forwardQueue.Push(source,0);
+            backwardQueue.Push(target,0);
+            long long best=INF;
+            int count=0;
+            while(true){
+                bool forwardLive=!forwardQueue.IsEmpty() && forwardQueue.TopKey()<best;
+                bool backwardLive=!backwardQueue.IsEmpty() && backwardQueue.TopKey()<best;
+                if(!forwardLive && !backwardLive){
+                    break;
+                }
+                count++;
+                if(forwardLive && (!backwardLive || forwardQueue.TopKey()<=backwardQueue.TopKey())){
+                    UpwardStep(up,forwardQueue,forwardDist,forwardStamp,backwardDist,backwardStamp,best);
+                }
+                else{
+                    UpwardStep(down,backwardQueue,backwardDist,backwardStamp,forwardDist,forwardStamp,best);
+                }
+            }
+            if(settled!=nullptr){
+                *settled=count;
+            }
+            return (int)best;
+        }
+
+        bool Save(string filename) const{
+            ofstream output(filename, ios::binary);
+            if(!output.is_open()){
+                return false;
+            }
+            uint32_t version=CH_VERSION;
+            output.write(CH_MAGIC,4);
+            output.write((const char*)&version,sizeof(version));
+            output.write((const char*)&numShortcuts,sizeof(numShortcuts));
+            int n=numVertices;
+            output.write((const char*)&n,sizeof(n));
+            output.write((const char*)rank.data(),sizeof(int)*(size_t)numVertices);
+            return up.Write(output) && down.Write(output);
+        }
+
+        bool Load(string filename){
+            ifstream input(filename, ios::binary);
+            if(!input.is_open()){
+                return false;
+            }
+            char magic[4];
+            uint32_t version;
+            int n;
+            if(!input.read(magic,4) || memcmp(magic,CH_MAGIC,4)!=0){
+                return false;
+            }
+            input.read((char*)&version,sizeof(version));
+            input.read((char*)&numShortcuts,sizeof(numShortcuts));
+            input.read((char*)&n,sizeof(n));
+            if(!input || version!=CH_VERSION || n<0){
+                return false;
+            }
+            numVertices=n;
+            rank.resize(numVertices);
+            input.read((char*)rank.data(),sizeof(int)*(size_t)numVertices);
+            if(!input || !up.Read(input) || !down.Read(input)){
+                return false;
+            }
+            PrepareQuery();
+            return true;
+        }
+};
+
+#endif
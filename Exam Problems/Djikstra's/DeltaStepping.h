@@ -0,0 +1,237 @@
+#ifndef DELTASTEPPING_H
+#define DELTASTEPPING_H
+
+#include <vector>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "../Common/ThreadPool.h"
+using namespace std;
+
+// Parallel delta-stepping (Meyer & Sanders). Tentative distances are
+// grouped into buckets of width delta. The current bucket is settled by
+// relaxing light edges (weight <= delta) until it stops changing, then
+// the heavy edges of everything it settled are relaxed once.
+//
+// Vertex v is owned by thread v % T. Relaxation requests are generated in
+// parallel into per-(sender, owner) buffers and each owner applies its own
+// requests, so no two threads ever write the same distance.
+class DeltaStepping{
+    private:
+        static const int PARALLEL_GRAIN=256;
+        // Most buckets per thread. A delta so small that the heaviest edge
+        // would need more is raised to fit.
+        static const int MAX_BUCKETS=4096;
+
+        struct Request{
+            int vertex;
+            int distance;
+            int pred;
+        };
+
+        const CSRGraph& graph;
+        ThreadPool& pool;
+        int delta;
+        int numThreads;
+        int numBuckets;
+
+        // buckets[owner][b] is a circular array of numBuckets buckets
+        vector<vector<vector<int>>> buckets;
+        vector<vector<vector<Request>>> requests;
+        vector<vector<int>> frontierParts;
+        vector<int> frontier;
+        vector<int> settled;
+        vector<int> frontierMark;
+        // Set by thread t when one of its sums saturated
+        vector<char> saturatedBy;
+
+        // Runs job(t) for every thread slot, on the pool only when there is
+        // enough work to pay for waking it up
+        void Phase(bool parallel, const function<void(int)>& job){
+            if(parallel){
+                pool.RunOnAll(job);
+            }
+            else{
+                for(int t=0;t<numThreads;t++){
+                    job(t);
+                }
+            }
+        }
+
+        void Relax(ShortestPathTree& result, const vector<int>& from, bool light){
+            vector<int>& distance=result.distance;
+            bool parallel=(int)from.size()>=PARALLEL_GRAIN;
+            Phase(parallel,[&](int t){
+                int begin=(int)((long long)from.size()*t/numThreads);
+                int end=(int)((long long)from.size()*(t+1)/numThreads);
+                vector<vector<Request>>& out=requests[t];
+                bool saturated=false;
+                for(int i=begin;i<end;i++){
+                    int u=from[i];
+                    int du=distance[u];
+                    for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                        int w=graph.weights[e];
+                        if((w<=delta)!=light){
+                            continue;
+                        }
+                        int v=graph.targets[e];
+                        int alt=WeightTraits<int>::Add(du,w,saturated);
+                        if(alt<distance[v]){
+                            out[v%numThreads].push_back({v,alt,u});
+                        }
+                    }
+                }
+                if(saturated){
+                    saturatedBy[t]=1;
+                }
+            });
+            Phase(parallel,[&](int owner){
+                for(int t=0;t<numThreads;t++){
+                    vector<Request>& in=requests[t][owner];
+                    for(const Request& r : in){
+                        if(r.distance<distance[r.vertex]){
+                            distance[r.vertex]=r.distance;
+                            result.pred[r.vertex]=r.pred;
+                            buckets[owner][(r.distance/delta)%numBuckets].push_back(r.vertex);
+                        }
+                    }
+                    in.clear();
+                }
+            });
+        }
+
+        // Lowest non-empty bucket index at or after index, or -1
+        int NextBucket(long long index){
+            for(int k=0;k<numBuckets;k++){
+                int b=(int)((index+k)%numBuckets);
+                for(int t=0;t<numThreads;t++){
+                    if(!buckets[t][b].empty()){
+                        return (int)(index+k);
+                    }
+                }
+            }
+            return -1;
+        }
+
+    public:
+        DeltaStepping(const CSRGraph& g, ThreadPool& p, int d) : graph(g), pool(p){
+            delta=d<1 ? 1 : d;
+            numThreads=pool.GetNumThreads();
+            long long maxWeight=graph.MaxWeight();
+            long long minDelta=(maxWeight+MAX_BUCKETS-3)/(MAX_BUCKETS-2);
+            if(delta<minDelta){
+                delta=(int)minDelta;
+            }
+            // Every tentative distance lies within maxWeight of the current
+            // bucket, so this many buckets can be reused cyclically
+            numBuckets=(int)(maxWeight/delta)+2;
+            buckets.assign(numThreads,vector<vector<int>>(numBuckets));
+            requests.assign(numThreads,vector<vector<Request>>(numThreads));
+            frontierParts.assign(numThreads,vector<int>());
+        }
+
+        // Common heuristic: the maximum weight divided by the average degree
+        static int DefaultDelta(const CSRGraph& g){
+            int maxWeight=g.MaxWeight();
+            int n=g.GetNumVertices()>0 ? g.GetNumVertices() : 1;
+            double avgDegree=(double)g.GetNumEdges()/n;
+            int d=(int)(maxWeight/(avgDegree>1 ? avgDegree : 1));
+            return d<1 ? 1 : d;
+        }
+
+        // The delta in use, which may be above the one asked for
+        int GetDelta() const{
+            return delta;
+        }
+
+        void Run(int source, ShortestPathTree& result){
+            int n=graph.GetNumVertices();
+            result.source=source;
+            result.distance.assign(n,INF);
+            result.pred.assign(n,-1);
+            frontierMark.assign(n,-1);
+            saturatedBy.assign(numThreads,0);
+            for(int t=0;t<numThreads;t++){
+                for(vector<int>& b : buckets[t]){
+                    b.clear();
+                }
+            }
+
+            result.distance[source]=0;
+            buckets[source%numThreads][0].push_back(source);
+            long long index=0;
+            int round=0;
+            while(true){
+                int next=NextBucket(index);
+                if(next<0){
+                    break;
+                }
+                index=next;
+                int b=(int)(index%numBuckets);
+                settled.clear();
+                while(true){
+                    // Take the live entries of bucket b: skip vertices whose
+                    // distance moved them to another bucket, and duplicates
+                    round++;
+                    long long pending=0;
+                    for(int t=0;t<numThreads;t++){
+                        pending+=buckets[t][b].size();
+                    }
+                    Phase(pending>=PARALLEL_GRAIN,[&](int owner){
+                        vector<int>& part=frontierParts[owner];
+                        part.clear();
+                        for(int v : buckets[owner][b]){
+                            if(result.distance[v]/delta==index && frontierMark[v]!=round){
+                                frontierMark[v]=round;
+                                part.push_back(v);
+                            }
+                        }
+                        buckets[owner][b].clear();
+                    });
+                    frontier.clear();
+                    for(int t=0;t<numThreads;t++){
+                        frontier.insert(frontier.end(),frontierParts[t].begin(),frontierParts[t].end());
+                    }
+                    if(frontier.empty()){
+                        break;
+                    }
+                    settled.insert(settled.end(),frontier.begin(),frontier.end());
+                    Relax(result,frontier,true);
+                }
+                Relax(result,settled,false);
+                index++;
+            }
+            result.saturated=find(saturatedBy.begin(),saturatedBy.end(),1)!=saturatedBy.end();
+        }
+};
+
+// Distances must match exactly. Predecessors may differ between equally
+// short paths, so each pred edge is checked to be tight instead.
+template<class Weight>
+bool VerifyShortestPaths(const BasicCSRGraph<Weight>& graph, const BasicShortestPathTree<Weight>& expected, const BasicShortestPathTree<Weight>& actual){
+    if(expected.distance!=actual.distance){
+        return false;
+    }
+    bool saturated=false;
+    for(int v=0;v<graph.GetNumVertices();v++){
+        int p=actual.pred[v];
+        if(p==-1){
+            if(v!=actual.source && actual.distance[v]!=WeightTraits<Weight>::Infinity()){
+                return false;
+            }
+            continue;
+        }
+        bool tight=false;
+        for(int e=graph.EdgeBegin(p);e<graph.EdgeEnd(p);e++){
+            if(graph.targets[e]==v && WeightTraits<Weight>::Add(actual.distance[p],graph.weights[e],saturated)==actual.distance[v]){
+                tight=true;
+                break;
+            }
+        }
+        if(!tight){
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef DENSEDIJKSTRA_H
+#define DENSEDIJKSTRA_H
+
+#include <vector>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+using namespace std;
+
+// Use the dense solver when at least this fraction of all V*V pairs are
+// edges and the matrix stays within DENSE_MAX_VERTICES^2 ints
+const double DENSE_MIN_DENSITY=0.25;
+const int DENSE_MAX_VERTICES=8192;
+
+// Row-major V x V weight matrix. Rows are padded to a multiple of 8 so the
+// vector loops never need a scalar tail. Which pairs are edges is kept in
+// a separate byte mask (-1 for an edge, 0 for none), so every int is a
+// valid weight and none has to be given up as a "no edge" marker.
+class DenseGraph{
+    private:
+        int numVertices=0;
+        int stride=0;
+        vector<int> matrix;
+        vector<int8_t> edges;
+    public:
+        static int Padded(int n){
+            return (n+7)/8*8;
+        }
+        void Build(const CSRGraph& graph){
+            numVertices=graph.GetNumVertices();
+            stride=Padded(numVertices);
+            matrix.assign((size_t)numVertices*stride,0);
+            edges.assign((size_t)numVertices*stride,0);
+            for(int u=0;u<numVertices;u++){
+                for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                    size_t at=(size_t)u*stride+graph.targets[e];
+                    // Parallel edges collapse to the lightest one
+                    if(edges[at]==0 || graph.weights[e]<matrix[at]){
+                        matrix[at]=graph.weights[e];
+                    }
+                    edges[at]=-1;
+                }
+            }
+        }
+        int GetNumVertices() const{
+            return numVertices;
+        }
+        int GetStride() const{
+            return stride;
+        }
+        const int* Row(int u) const{
+            return matrix.data()+(size_t)u*stride;
+        }
+        const int8_t* EdgeRow(int u) const{
+            return edges.data()+(size_t)u*stride;
+        }
+};
+
+// True when the graph is dense enough for DenseDijkstra to win. Without
+// -mavx2 or -msse4.1 the scalar loops lose to the heap, so never prefer it.
+// Weights of 2^30 and up are left to the heap too: two such edges already
+// pass INT_MAX, and a saturated answer there is no use to the caller.
+inline bool PreferDense(const CSRGraph& graph){
+#if !defined(__AVX2__) && !defined(__SSE4_1__)
+    return false;
+#endif
+    int n=graph.GetNumVertices();
+    if(n==0 || n>DENSE_MAX_VERTICES){
+        return false;
+    }
+    if((double)graph.GetNumEdges()/((double)n*n)<DENSE_MIN_DENSITY){
+        return false;
+    }
+    return graph.MaxWeight()<(1<<30);
+}
+
+// Index of the smallest key among the first n (a multiple of 8)
+inline int MinIndex(const int* key, int n){
+#if defined(__AVX2__)
+    __m256i best=_mm256_set1_epi32(INT_MAX);
+    __m256i bestIndex=_mm256_set1_epi32(-1);
+    __m256i index=_mm256_setr_epi32(0,1,2,3,4,5,6,7);
+    const __m256i step=_mm256_set1_epi32(8);
+    for(int i=0;i<n;i+=8){
+        __m256i k=_mm256_loadu_si256((const __m256i*)(key+i));
+        __m256i smaller=_mm256_cmpgt_epi32(best,k);
+        best=_mm256_min_epi32(best,k);
+        bestIndex=_mm256_blendv_epi8(bestIndex,index,smaller);
+        index=_mm256_add_epi32(index,step);
+    }
+    int lanes[8];
+    int lanesIndex[8];
+    _mm256_storeu_si256((__m256i*)lanes,best);
+    _mm256_storeu_si256((__m256i*)lanesIndex,bestIndex);
+    int result=lanesIndex[0];
+    int value=lanes[0];
+    for(int j=1;j<8;j++){
+        if(lanes[j]<value || (lanes[j]==value && lanesIndex[j]<result)){
+            value=lanes[j];
+            result=lanesIndex[j];
+        }
+    }
+    return result;
+#elif defined(__SSE4_1__)
+    __m128i best=_mm_set1_epi32(INT_MAX);
+    __m128i bestIndex=_mm_set1_epi32(-1);
+    __m128i index=_mm_setr_epi32(0,1,2,3);
+    const __m128i step=_mm_set1_epi32(4);
+    for(int i=0;i<n;i+=4){
+        __m128i k=_mm_loadu_si128((const __m128i*)(key+i));
+        __m128i smaller=_mm_cmpgt_epi32(best,k);
+        best=_mm_min_epi32(best,k);
+        bestIndex=_mm_blendv_epi8(bestIndex,index,smaller);
+        index=_mm_add_epi32(index,step);
+    }
+    int lanes[4];
+    int lanesIndex[4];
+    _mm_storeu_si128((__m128i*)lanes,best);
+    _mm_storeu_si128((__m128i*)lanesIndex,bestIndex);
+    int result=lanesIndex[0];
+    int value=lanes[0];
+    for(int j=1;j<4;j++){
+        if(lanes[j]<value || (lanes[j]==value && lanesIndex[j]<result)){
+            value=lanes[j];
+            result=lanesIndex[j];
+        }
+    }
+    return result;
+#else
+    int result=-1;
+    int value=INT_MAX;
+    for(int i=0;i<n;i++){
+        if(key[i]<value){
+            value=key[i];
+            result=i;
+        }
+    }
+    return result;
+#endif
+}
+
+// key[v] = min(key[v], du + row[v]) with pred[v] = u wherever that
+// improves, skipping missing edges and settled vertices. A sum that would
+// reach INF saturates there, like WeightTraits::Add: the lanes compare w
+// against INF - du before adding, and the wrapped sum is blended away.
+// Returns true when some live edge saturated.
+inline bool RelaxRow(const int* row, const int8_t* edge, int du, int u, int* key, int* pred, const int* settled, int n){
+#if defined(__AVX2__)
+    const __m256i base=_mm256_set1_epi32(du);
+    const __m256i from=_mm256_set1_epi32(u);
+    const __m256i limit=_mm256_set1_epi32(INF-du-1);
+    const __m256i inf=_mm256_set1_epi32(INF);
+    __m256i clamped=_mm256_setzero_si256();
+    for(int i=0;i<n;i+=8){
+        __m256i w=_mm256_loadu_si256((const __m256i*)(row+i));
+        __m256i k=_mm256_loadu_si256((const __m256i*)(key+i));
+        __m256i s=_mm256_loadu_si256((const __m256i*)(settled+i));
+        __m256i live=_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(edge+i)));
+        live=_mm256_andnot_si256(s,live);
+        __m256i overflow=_mm256_cmpgt_epi32(w,limit);
+        __m256i candidate=_mm256_blendv_epi8(_mm256_add_epi32(base,w),inf,overflow);
+        clamped=_mm256_or_si256(clamped,_mm256_and_si256(overflow,live));
+        __m256i improved=_mm256_and_si256(_mm256_cmpgt_epi32(k,candidate),live);
+        if(_mm256_testz_si256(improved,improved)){
+            continue;
+        }
+        __m256i p=_mm256_loadu_si256((const __m256i*)(pred+i));
+        _mm256_storeu_si256((__m256i*)(key+i),_mm256_blendv_epi8(k,candidate,improved));
+        _mm256_storeu_si256((__m256i*)(pred+i),_mm256_blendv_epi8(p,from,improved));
+    }
+    return !_mm256_testz_si256(clamped,clamped);
+#elif defined(__SSE4_1__)
+    const __m128i base=_mm_set1_epi32(du);
+    const __m128i from=_mm_set1_epi32(u);
+    const __m128i limit=_mm_set1_epi32(INF-du-1);
+    const __m128i inf=_mm_set1_epi32(INF);
+    __m128i clamped=_mm_setzero_si128();
+    for(int i=0;i<n;i+=4){
+        __m128i w=_mm_loadu_si128((const __m128i*)(row+i));
+        __m128i k=_mm_loadu_si128((const __m128i*)(key+i));
+        __m128i s=_mm_loadu_si128((const __m128i*)(settled+i));
+        int32_t edgeBytes;
+        memcpy(&edgeBytes,edge+i,sizeof(edgeBytes));
+        __m128i live=_mm_cvtepi8_epi32(_mm_cvtsi32_si128(edgeBytes));
+        live=_mm_andnot_si128(s,live);
+        __m128i overflow=_mm_cmpgt_epi32(w,limit);
+        __m128i candidate=_mm_blendv_epi8(_mm_add_epi32(base,w),inf,overflow);
+        clamped=_mm_or_si128(clamped,_mm_and_si128(overflow,live));
+        __m128i improved=_mm_and_si128(_mm_cmpgt_epi32(k,candidate),live);
+        if(_mm_testz_si128(improved,improved)){
+            continue;
+        }
+        __m128i p=_mm_loadu_si128((const __m128i*)(pred+i));
+        _mm_storeu_si128((__m128i*)(key+i),_mm_blendv_epi8(k,candidate,improved));
+        _mm_storeu_si128((__m128i*)(pred+i),_mm_blendv_epi8(p,from,improved));
+    }
+    return !_mm_testz_si128(clamped,clamped);
+#else
+    // Written without branches so the compiler can vectorize it itself;
+    // the sum is taken unsigned so the discarded lanes cannot overflow
+    int limit=INF-du;
+    bool clamped=false;
+    for(int i=0;i<n;i++){
+        bool live=(edge[i]!=0) & (settled[i]==0);
+        bool overflow=row[i]>=limit;
+        int candidate=overflow ? INF : (int)((unsigned)du+(unsigned)row[i]);
+        bool improved=live & (candidate<key[i]);
+        clamped|=live & overflow;
+        key[i]=improved ? candidate : key[i];
+        pred[i]=improved ? u : pred[i];
+    }
+    return clamped;
+#endif
+}
+
+// O(V^2) array Dijkstra with no heap: each round picks the unsettled
+// vertex with the smallest key by a vector min-scan, then relaxes its
+// whole matrix row with vector compares and blends.
+class DenseDijkstra{
+    private:
+        vector<int> key;
+        vector<int> pred;
+        vector<int> settled;
+    public:
+        void Run(const DenseGraph& graph, int source, ShortestPathTree& result){
+            int n=graph.GetNumVertices();
+            int padded=graph.GetStride();
+            // Padding lanes are settled with key INF so they never win
+            key.assign(padded,INF);
+            pred.assign(padded,-1);
+            settled.assign(padded,0);
+            for(int i=n;i<padded;i++){
+                settled[i]=-1;
+            }
+            result.source=source;
+            result.distance.assign(n,INF);
+            result.pred.assign(n,-1);
+            result.saturated=false;
+
+            key[source]=0;
+            for(int round=0;round<n;round++){
+                int u=MinIndex(key.data(),padded);
+                if(u<0 || key[u]==INF){
+                    break;
+                }
+                int du=key[u];
+                result.distance[u]=du;
+                result.pred[u]=pred[u];
+                settled[u]=-1;
+                key[u]=INF;
+                if(RelaxRow(graph.Row(u),graph.EdgeRow(u),du,u,key.data(),pred.data(),settled.data(),padded)){
+                    result.saturated=true;
+                }
+            }
+        }
+};
+
+#endif
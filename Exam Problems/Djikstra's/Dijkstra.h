@@ -0,0 +1,294 @@
+#ifndef DIJKSTRA_H
+#define DIJKSTRA_H
+
+#include <vector>
+#include <climits>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include "CSRGraph.h"
+#include "IndexedHeap.h"
+#include "RadixHeap.h"
+#include "BucketQueue.h"
+using namespace std;
+
+const int INF = INT_MAX;
+
+// Distance arithmetic for each weight type. Infinity() marks an
+// unreachable vertex (INF for int). An integer sum that would reach it
+// saturates there instead of wrapping round to a small number, and
+// floating-point sums already overflow to +inf; either way the caller is
+// told so it can switch to a wider type.
+template<class Weight>
+struct WeightTraits{
+    static Weight Infinity(){
+        return numeric_limits<Weight>::has_infinity ? numeric_limits<Weight>::infinity() : numeric_limits<Weight>::max();
+    }
+    // d + w for a finite d and w >= 0
+    static Weight Add(Weight d, Weight w, bool& saturated){
+        if(numeric_limits<Weight>::is_integer){
+            if(w>=Infinity()-d){
+                saturated=true;
+                return Infinity();
+            }
+            return d+w;
+        }
+        Weight sum=d+w;
+        if(sum==Infinity()){
+            saturated=true;
+        }
+        return sum;
+    }
+};
+
+// Result of a single-source query: distance[v] is Infinity() when v is
+// unreachable and pred[v] is -1 for the source and unreachable vertices.
+// saturated is set when some path was too long for Weight; distances
+// beyond the range then read as unreachable.
+template<class Weight>
+struct BasicShortestPathTree{
+    int source=-1;
+    vector<Weight> distance;
+    vector<int> pred;
+    bool saturated=false;
+};
+
+typedef BasicShortestPathTree<int> ShortestPathTree;
+
+// Observer that does nothing. Every hook is an empty inline function,
+// so Dijkstra<NullObserver> compiles down to the bare algorithm.
+struct NullObserver{
+    template<class Workspace>
+    void OnInit(const Workspace&){}
+    template<class Weight>
+    void OnSettle(int, Weight){}
+    template<class Weight>
+    void OnRelax(int, int, Weight, Weight, Weight, bool){}
+    template<class Workspace>
+    void OnSettled(int, const Workspace&){}
+};
+
+// Counts the work of a query. Each settled vertex is one heap pop and
+// each improving relaxation one push or decrease-key; relaxed counts the
+// edges looked at into vertices that were not yet settled.
+struct CountingObserver{
+    long long settled=0;
+    long long relaxed=0;
+    long long improved=0;
+
+    template<class Workspace>
+    void OnInit(const Workspace&){}
+    template<class Weight>
+    void OnSettle(int, Weight){
+        settled++;
+    }
+    template<class Weight>
+    void OnRelax(int, int, Weight, Weight, Weight, bool better){
+        relaxed++;
+        if(better){
+            improved++;
+        }
+    }
+    template<class Workspace>
+    void OnSettled(int, const Workspace&){}
+    // Pushes, decrease-keys and pops, counting the source's first push
+    long long HeapOperations() const{
+        return 1+improved+settled;
+    }
+};
+
+// Per-vertex state for one query as flat arrays, reused from query to
+// query. distance and pred only count for vertices whose stamp matches
+// the current round, so Begin costs O(vertices the last query touched)
+// and, once the arrays have grown to the graph, allocates nothing.
+// Queue is any of IndexedDHeap, RadixHeap or BucketQueue, and its key
+// type is the distance type.
+template<class Queue>
+class BasicDijkstraWorkspace{
+    public:
+        typedef typename Queue::KeyType Weight;
+    private:
+        vector<Weight> distance;
+        vector<int> pred;
+        vector<unsigned> stamp;
+        vector<uint64_t> visited;
+        vector<int> touched;
+        unsigned round=0;
+        bool saturated=false;
+    public:
+        Queue unvisited;
+
+        void Begin(int n){
+            if((int)stamp.size()!=n){
+                distance.resize(n);
+                pred.resize(n);
+                stamp.assign(n,0);
+                visited.assign((n+63)/64,0);
+                touched.clear();
+                round=0;
+                unvisited.Reset(n);
+            }
+            else{
+                for(int v : touched){
+                    visited[v>>6]&=~(1ULL<<(v&63));
+                }
+                touched.clear();
+                unvisited.Clear();
+            }
+            saturated=false;
+            round++;
+            if(round==0){
+                // The counter wrapped, so old stamps could match again
+                fill(stamp.begin(),stamp.end(),0);
+                round=1;
+            }
+        }
+        int GetNumVertices() const{
+            return (int)stamp.size();
+        }
+        Weight GetDistance(int v) const{
+            return stamp[v]==round ? distance[v] : WeightTraits<Weight>::Infinity();
+        }
+        int GetPred(int v) const{
+            return stamp[v]==round ? pred[v] : -1;
+        }
+        void SetDistance(int v, Weight d, int p){
+            if(stamp[v]!=round){
+                stamp[v]=round;
+                touched.push_back(v);
+            }
+            distance[v]=d;
+            pred[v]=p;
+        }
+        bool IsVisited(int v) const{
+            return (visited[v>>6]>>(v&63))&1;
+        }
+        void Visit(int v){
+            visited[v>>6]|=1ULL<<(v&63);
+        }
+        // True when some path since Begin was too long for Weight
+        bool HasSaturated() const{
+            return saturated;
+        }
+        void SetSaturated(){
+            saturated=true;
+        }
+        // Every vertex given a distance since Begin, in discovery order
+        const vector<int>& GetTouched() const{
+            return touched;
+        }
+        // Writes the whole tree out, O(V)
+        void Export(int source, BasicShortestPathTree<Weight>& result) const{
+            int n=GetNumVertices();
+            result.source=source;
+            result.saturated=saturated;
+            result.distance.resize(n);
+            result.pred.resize(n);
+            for(int v=0;v<n;v++){
+                bool reached=stamp[v]==round;
+                result.distance[v]=reached ? distance[v] : WeightTraits<Weight>::Infinity();
+                result.pred[v]=reached ? pred[v] : -1;
+            }
+        }
+};
+
+typedef BasicDijkstraWorkspace<IndexedDHeap<>> DijkstraWorkspace;
+
+// Workspace for graphs with Weight-typed edges, e.g. BasicCSRGraph<long long>
+template<class Weight>
+using WeightedDijkstraWorkspace=BasicDijkstraWorkspace<IndexedDHeap<4,Weight>>;
+
+// Priority queues the solver can be run with when the choice is made at
+// run time. The radix heap and bucket queue need non-negative integer
+// weights; the bucket queue also needs a small maximum weight.
+enum class QueueType{
+    DHeap,
+    RadixHeap,
+    BucketQueue
+};
+
+// Dijkstra's algorithm over a CSR graph with no I/O. The answer is left in
+// the workspace; the observer is told about every step, which is how
+// Graph::DSP prints its trace. Relaxation goes through WeightTraits::Add,
+// so a path too long for Weight saturates instead of wrapping.
+template<class Weight, class Queue, class Observer>
+void Dijkstra(const BasicCSRGraph<Weight>& graph, int source, BasicDijkstraWorkspace<Queue>& workspace, Observer& observer){
+    static_assert(is_same<Weight,typename Queue::KeyType>::value,"queue keys must have the edge weight type");
+    workspace.Begin(graph.GetNumVertices());
+    Queue& unvisited=workspace.unvisited;
+    bool saturated=false;
+
+    workspace.SetDistance(source,0,-1);
+    unvisited.Push(source,0);
+    observer.OnInit(workspace);
+
+    while(!unvisited.IsEmpty()){
+        int u=unvisited.Pop();
+        Weight du=workspace.GetDistance(u);
+        workspace.Visit(u);
+        observer.OnSettle(u,du);
+        for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+            int v=graph.targets[e];
+            if(workspace.IsVisited(v)){
+                continue;
+            }
+            Weight weight=graph.weights[e];
+            Weight alternatePathDistance=WeightTraits<Weight>::Add(du,weight,saturated);
+            Weight old=workspace.GetDistance(v);
+            bool improved=alternatePathDistance<old;
+            observer.OnRelax(u,v,weight,old,alternatePathDistance,improved);
+            if(improved){
+                workspace.SetDistance(v,alternatePathDistance,u);
+                unvisited.PushOrDecrease(v,alternatePathDistance);
+            }
+        }
+        observer.OnSettled(u,workspace);
+    }
+    if(saturated){
+        workspace.SetSaturated();
+    }
+}
+
+// Same, with the whole tree written to result
+template<class Weight, class Queue, class Observer>
+void Dijkstra(const BasicCSRGraph<Weight>& graph, int source, BasicShortestPathTree<Weight>& result, BasicDijkstraWorkspace<Queue>& workspace, Observer& observer){
+    Dijkstra(graph,source,workspace,observer);
+    workspace.Export(source,result);
+}
+
+template<class Weight, class Observer>
+void Dijkstra(const BasicCSRGraph<Weight>& graph, int source, BasicShortestPathTree<Weight>& result, Observer& observer){
+    WeightedDijkstraWorkspace<Weight> workspace;
+    Dijkstra(graph,source,result,workspace,observer);
+}
+
+template<class Weight, class Queue>
+void Dijkstra(const BasicCSRGraph<Weight>& graph, int source, BasicShortestPathTree<Weight>& result, BasicDijkstraWorkspace<Queue>& workspace){
+    NullObserver observer;
+    Dijkstra(graph,source,result,workspace,observer);
+}
+
+template<class Weight>
+void Dijkstra(const BasicCSRGraph<Weight>& graph, int source, BasicShortestPathTree<Weight>& result){
+    WeightedDijkstraWorkspace<Weight> workspace;
+    Dijkstra(graph,source,result,workspace);
+}
+
+// Runs the silent solver with the queue picked at run time. A bucket
+// queue asked for on a graph with weights above BucketQueue::MAX_WEIGHT
+// falls back to the heap.
+inline void Dijkstra(const CSRGraph& graph, int source, ShortestPathTree& result, QueueType type){
+    BasicDijkstraWorkspace<BucketQueue> buckets;
+    if(type==QueueType::RadixHeap){
+        BasicDijkstraWorkspace<RadixHeap> workspace;
+        Dijkstra(graph,source,result,workspace);
+    }
+    else if(type==QueueType::BucketQueue && buckets.unvisited.SetMaxWeight(graph.MaxWeight())){
+        Dijkstra(graph,source,result,buckets);
+    }
+    else{
+        Dijkstra(graph,source,result);
+    }
+}
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef DYNAMICSSSP_H
+#define DYNAMICSSSP_H
+
+#include <vector>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "IndexedHeap.h"
+using namespace std;
+
+// Single-source shortest paths that stay correct while edges change. The
+// graph is copied into mutable adjacency lists and the shortest-path tree
+// is repaired after every edit instead of being recomputed:
+//  - an edge that got shorter (or was inserted) can only lower distances,
+//    so a Dijkstra search seeded at its head fixes everything it reaches
+//  - an edge that got longer (or was deleted) only matters if it is a tree
+//    edge. Then the subtree under its head loses its distances, each of
+//    those vertices takes the best offer from an in-neighbour outside the
+//    subtree, and a Dijkstra search over the subtree settles the rest.
+// Both cases touch only the vertices whose tree changes and their edges,
+// in the style of Ramalingam and Reps.
+class DynamicShortestPaths{
+    private:
+        struct Arc{
+            int to;
+            int weight;
+        };
+
+        int numVertices;
+        vector<vector<Arc>> out;
+        vector<vector<Arc>> in;
+        ShortestPathTree tree;
+        IndexedDHeap<> queue;
+        vector<int> affectedStamp;
+        int round=0;
+        vector<int> affected;
+        int lastTouched=0;
+
+        bool Valid(int v) const{
+            return v>=0 && v<numVertices;
+        }
+        static Arc* Find(vector<Arc>& arcs, int to){
+            for(Arc& a : arcs){
+                if(a.to==to){
+                    return &a;
+                }
+            }
+            return nullptr;
+        }
+        static void Erase(vector<Arc>& arcs, int to){
+            for(int i=0;i<(int)arcs.size();i++){
+                if(arcs[i].to==to){
+                    arcs[i]=arcs.back();
+                    arcs.pop_back();
+                    return;
+                }
+            }
+        }
+
+        // Dijkstra from whatever is already in the queue
+        void Propagate(){
+            vector<int>& distance=tree.distance;
+            while(!queue.IsEmpty()){
+                int x=queue.Pop();
+                lastTouched++;
+                for(const Arc& a : out[x]){
+                    int alternatePathDistance=WeightTraits<int>::Add(distance[x],a.weight,tree.saturated);
+                    if(alternatePathDistance<distance[a.to]){
+                        distance[a.to]=alternatePathDistance;
+                        tree.pred[a.to]=x;
+                        queue.PushOrDecrease(a.to,alternatePathDistance);
+                    }
+                }
+            }
+        }
+
+        // u->v now weighs w (or was just added)
+        void Decreased(int u, int v, int w){
+            if(tree.distance[u]==INF){
+                return;
+            }
+            int alternatePathDistance=WeightTraits<int>::Add(tree.distance[u],w,tree.saturated);
+            if(alternatePathDistance<tree.distance[v]){
+                tree.distance[v]=alternatePathDistance;
+                tree.pred[v]=u;
+                queue.Push(v,alternatePathDistance);
+                Propagate();
+            }
+        }
+
+        // u->v got longer or is gone
+        void Increased(int u, int v){
+            if(tree.pred[v]!=u){
+                return;
+            }
+            vector<int>& distance=tree.distance;
+            vector<int>& pred=tree.pred;
+            round++;
+            affected.clear();
+            affected.push_back(v);
+            affectedStamp[v]=round;
+            for(int i=0;i<(int)affected.size();i++){
+                int x=affected[i];
+                for(const Arc& a : out[x]){
+                    if(pred[a.to]==x && affectedStamp[a.to]!=round){
+                        affectedStamp[a.to]=round;
+                        affected.push_back(a.to);
+                    }
+                }
+            }
+            for(int x : affected){
+                distance[x]=INF;
+                pred[x]=-1;
+            }
+            for(int x : affected){
+                for(const Arc& a : in[x]){
+                    int y=a.to;
+                    if(affectedStamp[y]==round || distance[y]==INF){
+                        continue;
+                    }
+                    int offer=WeightTraits<int>::Add(distance[y],a.weight,tree.saturated);
+                    if(offer<distance[x]){
+                        distance[x]=offer;
+                        pred[x]=y;
+                    }
+                }
+                if(distance[x]!=INF){
+                    queue.Push(x,distance[x]);
+                }
+            }
+            lastTouched+=(int)affected.size();
+            Propagate();
+        }
+
+    public:
+        DynamicShortestPaths(const CSRGraph& graph){
+            numVertices=graph.GetNumVertices();
+            out.resize(numVertices);
+            in.resize(numVertices);
+            for(int u=0;u<numVertices;u++){
+                for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                    out[u].push_back({graph.targets[e],graph.weights[e]});
+                    in[graph.targets[e]].push_back({u,graph.weights[e]});
+                }
+            }
+            affectedStamp.assign(numVertices,0);
+        }
+
+        // Full Dijkstra from source; edits after this are repaired
+        void Compute(int source){
+            tree.source=source;
+            tree.distance.assign(numVertices,INF);
+            tree.pred.assign(numVertices,-1);
+            tree.saturated=false;
+            queue.Reset(numVertices);
+            tree.distance[source]=0;
+            queue.Push(source,0);
+            lastTouched=0;
+            Propagate();
+        }
+
+        // Each edit returns false and changes nothing when a vertex is out
+        // of range, the weight is not positive, or the edge is missing
+        // (present, for InsertEdge)
+        bool UpdateEdge(int u, int v, int w){
+            if(!Valid(u) || !Valid(v) || w<=0){
+                return false;
+            }
+            Arc* forward=Find(out[u],v);
+            if(forward==nullptr){
+                return false;
+            }
+            int old=forward->weight;
+            forward->weight=w;
+            Find(in[v],u)->weight=w;
+            lastTouched=0;
+            if(w<old){
+                Decreased(u,v,w);
+            }
+            else if(w>old){
+                Increased(u,v);
+            }
+            return true;
+        }
+        bool InsertEdge(int u, int v, int w){
+            if(!Valid(u) || !Valid(v) || w<=0 || Find(out[u],v)!=nullptr){
+                return false;
+            }
+            out[u].push_back({v,w});
+            in[v].push_back({u,w});
+            lastTouched=0;
+            Decreased(u,v,w);
+            return true;
+        }
+        bool DeleteEdge(int u, int v){
+            if(!Valid(u) || !Valid(v) || Find(out[u],v)==nullptr){
+                return false;
+            }
+            Erase(out[u],v);
+            Erase(in[v],u);
+            lastTouched=0;
+            Increased(u,v);
+            return true;
+        }
+
+        const ShortestPathTree& GetTree() const{
+            return tree;
+        }
+        int GetNumVertices() const{
+            return numVertices;
+        }
+        // Vertices settled or invalidated by the last edit
+        int GetLastTouched() const{
+            return lastTouched;
+        }
+        // Current edges as a CSR graph, for checking against a full rerun
+        CSRGraph ToCSR() const{
+            vector<int> src;
+            vector<int> dst;
+            vector<int> w;
+            for(int u=0;u<numVertices;u++){
+                for(const Arc& a : out[u]){
+                    src.push_back(u);
+                    dst.push_back(a.to);
+                    w.push_back(a.weight);
+                }
+            }
+            CSRGraph graph;
+            graph.Build(numVertices,src,dst,w);
+            return graph;
+        }
+};
+
+#endif
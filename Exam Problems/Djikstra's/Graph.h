@@ -6,29 +6,27 @@
 #include <fstream>
 #include <climits>
 #include <iomanip>
+#include "CSRGraph.h"
+#include "IndexedHeap.h"
+#include "Dijkstra.h"
+#include "DeltaStepping.h"
+#include "PointToPoint.h"
+#include "DenseDijkstra.h"
+#include "PartitionedSSSP.h"
+#include <memory>
 using namespace std;
 
-const int INF = INT_MAX;
-
+// Vertex record used only by the PQueue baseline below. DSP keeps its
+// per-vertex state in the flat arrays of DijkstraWorkspace.
 struct Vertex{
     int distance;
     int vertexNum;
     Vertex* predV;
-    vector<Vertex*> adjVertices;
-};
-
-class QueueException : public exception{
-    private:
-        string message;
-    public:
-        QueueException(const string& msg){
-            message=msg;   
-        }
-        const char* what() const noexcept override{
-            return message.c_str();   
-        }
 };
 
+// Original lazy-deletion heap: an improved vertex is enqueued again and the
+// stale copy is skipped when dequeued. DSP uses IndexedDHeap now; this is
+// kept as the baseline for Benchmark.cpp.
 class PQueue{
     private:
         int size;
@@ -161,203 +159,247 @@ class PQueue{
         }
 };
 
-class Graph{
+// Prints the step-by-step trace that DSP used to print inline
+class TraceObserver{
     private:
-        PQueue unvisited;
-        vector<Vertex*> allVertices;
+        const CSRGraph& graph;
+        int step;
         
         // Helper to print distance table
-        void PrintDistanceTable(vector<bool>& visited, int numVertices){
+        void PrintDistanceTable(const DijkstraWorkspace& workspace){
             cout << "   +--------+----------+----------+" << endl;
             cout << "   | Vertex | Distance |  Visited |" << endl;
             cout << "   +--------+----------+----------+" << endl;
-            for(int i = 0; i < numVertices; i++){
+            for(int i = 0; i < workspace.GetNumVertices(); i++){
                 cout << "   |   " << i << "    |";
-                if(allVertices[i]->distance == INF){
+                if(workspace.GetDistance(i) == INF){
                     cout << "   INF    |";
                 } else {
-                    cout << setw(6) << allVertices[i]->distance << "    |";
+                    cout << setw(6) << workspace.GetDistance(i) << "    |";
                 }
-                cout << (visited[i] ? "   Yes    |" : "   No     |") << endl;
+                cout << (workspace.IsVisited(i) ? "   Yes    |" : "   No     |") << endl;
             }
             cout << "   +--------+----------+----------+" << endl;
         }
         
     public:
-        void DSP(int start, string filename){
-            ifstream input(filename);
-            if(!input.is_open()){
-                cout << "Error: Could not open file " << filename << endl;
-                return;
-            }
-            
-            int size;
-            int a;
-            int b;
-            int weight;
-            input>>size;
-            vector<vector<int>> matrix;
-            matrix.resize(size,vector<int>(size));
-            
-            while(input>>a){
-                input>>b;
-                input>>weight;
-                matrix[a][b]=weight;
-            }
-            input.close();
+        TraceObserver(const CSRGraph& g) : graph(g){
+            step=1;
+        }
+        void OnInit(const DijkstraWorkspace& workspace){
+            const IndexedDHeap<>& heap=workspace.unvisited;
+            int start=heap.Top();
+            cout << "\n=== INITIALIZATION ===" << endl;
+            cout << "Starting vertex: " << start << endl;
+            cout << "Setting distance[" << start << "] = 0, all others = INF" << endl;
+            PrintDistanceTable(workspace);
+            heap.PrintQueue();
             
-            // Print adjacency matrix
-            cout << "\n=== ADJACENCY MATRIX ===" << endl;
-            cout << "    ";
-            for(int i = 0; i < size; i++){
-                cout << setw(3) << i << " ";
+            cout << "\n=== DIJKSTRA'S ALGORITHM ===" << endl;
+        }
+        void OnSettle(int u, int distance){
+            cout << "\n--- Step " << step++ << ": Process V" << u << " (distance = " << distance << ") ---" << endl;
+            cout << "   Marked V" << u << " as visited" << endl;
+
+            // Find neighbors
+            cout << "   Checking neighbors of V" << u << ": ";
+            bool hasNeighbors = false;
+            for(int e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++){
+                if(hasNeighbors) cout << ", ";
+                cout << "V" << graph.targets[e] << "(weight=" << graph.weights[e] << ")";
+                hasNeighbors = true;
             }
+            if(!hasNeighbors) cout << "none";
             cout << endl;
-            cout << "   +";
-            for(int i = 0; i < size; i++){
-                cout << "----";
+        }
+        void OnRelax(int u, int v, int weight, int oldDistance, int newDistance, bool improved){
+            cout << "   -> V" << v << ": ";
+            cout << "current distance = ";
+            if(oldDistance == INF) cout << "INF";
+            else cout << oldDistance;
+            cout << ", new distance via V" << u << " = " << newDistance - weight << " + " << weight << " = " << newDistance;
+            if(improved){
+                cout << " (SHORTER! Updating)" << endl;
             }
+            else{
+                cout << " (not shorter, skip)" << endl;
+            }
+        }
+        void OnSettled(int, const DijkstraWorkspace& workspace){
             cout << endl;
-            
-            for(int i=0;i<size;i++){
-                cout << " " << i << " |";
-                for(int j=0;j<size;j++){
-                    if(matrix[i][j]!=0){
-                        cout << setw(3) << matrix[i][j] << " ";
-                    } 
-                    else{
-                        cout << " -- ";   
-                    }   
-                } 
-                cout<<endl;
+            PrintDistanceTable(workspace);
+            workspace.unvisited.PrintQueue();
+        }
+};
+
+class Graph{
+    private:
+        CSRGraph graph;
+        string filename;
+        unique_ptr<PointToPointSearch> pointToPoint;
+        unique_ptr<DenseGraph> dense;
+        DenseDijkstra denseSolver;
+        
+        PointToPointSearch& GetPointToPoint(){
+            // Built on first use since it keeps a reversed copy of the graph
+            if(!pointToPoint){
+                pointToPoint.reset(new PointToPointSearch(graph));
             }
+            return *pointToPoint;
+        }
+        
+        void PrintGraph(){
+            int size=graph.GetNumVertices();
             
-            // Initialize visited array
-            vector<bool> visited(size, false);
-            
-            // Initialize all vertices
-            cout << "\n=== INITIALIZATION ===" << endl;
-            cout << "Starting vertex: " << start << endl;
-            cout << "Setting distance[" << start << "] = 0, all others = INF" << endl;
-            
-            for(int i=0;i<matrix.size();i++){
-                Vertex* currentV=new Vertex();
-                currentV->predV=nullptr;
-                currentV->vertexNum=i;
-                if(i==start){
-                    currentV->distance=0;   
-                    unvisited.Enqueue(currentV);
+            // Print adjacency matrix for small graphs, adjacency lists otherwise
+            if(size <= 20){
+                cout << "\n=== ADJACENCY MATRIX ===" << endl;
+                cout << "    ";
+                for(int i = 0; i < size; i++){
+                    cout << setw(3) << i << " ";
                 }
-                else{
-                    currentV->distance=INF;   
-                }
-                allVertices.push_back(currentV);
-            }
-            
-            PrintDistanceTable(visited, size);
-            unvisited.PrintQueue();
-            
-            // Dijkstra's algorithm 
-            cout << "\n=== DIJKSTRA'S ALGORITHM ===" << endl;
-            int step = 1;
-            
-            while(!unvisited.IsEmpty()){
-                Vertex* currentV=unvisited.Dequeue();
-
-                // Skip if already visited 
-                if(visited[currentV->vertexNum]){
-                    cout << "\n--- Step " << step++ << ": Dequeued V" << currentV->vertexNum << " (already visited, skipping) ---" << endl;
-                    continue;
+                cout << endl;
+                cout << "   +";
+                for(int i = 0; i < size; i++){
+                    cout << "----";
                 }
+                cout << endl;
                 
-                cout << "\n--- Step " << step++ << ": Process V" << currentV->vertexNum << " (distance = " << currentV->distance << ") ---" << endl;
-                visited[currentV->vertexNum]=true;
-                cout << "   Marked V" << currentV->vertexNum << " as visited" << endl;
-
-                // Find neighbors
-                cout << "   Checking neighbors of V" << currentV->vertexNum << ": ";
-                bool hasNeighbors = false;
-                for(int i = 0; i < matrix.size(); i++){
-                    if(matrix[currentV->vertexNum][i] != 0){
-                        if(hasNeighbors) cout << ", ";
-                        cout << "V" << i << "(weight=" << matrix[currentV->vertexNum][i] << ")";
-                        hasNeighbors = true;
+                vector<int> row(size);
+                for(int i=0;i<size;i++){
+                    fill(row.begin(),row.end(),0);
+                    for(int e=graph.EdgeBegin(i);e<graph.EdgeEnd(i);e++){
+                        row[graph.targets[e]]=graph.weights[e];
                     }
+                    cout << " " << i << " |";
+                    for(int j=0;j<size;j++){
+                        if(row[j]!=0){
+                            cout << setw(3) << row[j] << " ";
+                        } 
+                        else{
+                            cout << " -- ";   
+                        }   
+                    } 
+                    cout<<endl;
                 }
-                if(!hasNeighbors) cout << "none";
-                cout << endl;
-
-                // Process all adjacent vertices
-                for(int i=0;i<matrix.size();i++){
-                    if(matrix[currentV->vertexNum][i]!=0 && !visited[i]){
-                        Vertex* adjV=allVertices[i];
-                        int edgeWeight=matrix[currentV->vertexNum][i];
-                        
-                        // Only update if current vertex has a valid distance
-                        if(currentV->distance != INF){
-                            int alternatePathDistance=currentV->distance+edgeWeight;
-                            
-                            cout << "   -> V" << i << ": ";
-                            cout << "current distance = ";
-                            if(adjV->distance == INF) cout << "INF";
-                            else cout << adjV->distance;
-                            cout << ", new distance via V" << currentV->vertexNum << " = " << currentV->distance << " + " << edgeWeight << " = " << alternatePathDistance;
-                            
-                            if(alternatePathDistance<adjV->distance){
-                                cout << " (SHORTER! Updating)" << endl;
-                                adjV->distance=alternatePathDistance;
-                                adjV->predV=currentV; 
-                                unvisited.Enqueue(adjV);
-                            }
-                            else{
-                                cout << " (not shorter, skip)" << endl;
-                            }
-                        }
-                    }   
+            }
+            else{
+                cout << "\n=== ADJACENCY LISTS ===" << endl;
+                for(int i=0;i<size;i++){
+                    cout << " " << i << " :";
+                    for(int e=graph.EdgeBegin(i);e<graph.EdgeEnd(i);e++){
+                        cout << " V" << graph.targets[e] << "(" << graph.weights[e] << ")";
+                    }
+                    cout << endl;
                 }
-                
-                cout << endl;
-                PrintDistanceTable(visited, size);
-                unvisited.PrintQueue();
+            }
+        }
+        
+    public:
+        bool Load(string file){
+            pointToPoint.reset();
+            dense.reset();
+            filename=file;
+            return graph.Load(file);
+        }
+        const CSRGraph& GetCSR() const{
+            return graph;
+        }
+        
+        // Silent query on the loaded graph: no output at all. Dense graphs
+        // go to the O(V^2) array solver, sparse ones to the heap solver.
+        void ShortestPaths(int start, ShortestPathTree& result){
+            if(PreferDense(graph)){
+                if(!dense){
+                    dense.reset(new DenseGraph());
+                    dense->Build(graph);
+                }
+                denseSolver.Run(*dense,start,result);
+            }
+            else{
+                Dijkstra(graph,start,result);
+            }
+        }
+        
+        // Same, with the priority queue chosen at run time
+        void ShortestPaths(int start, ShortestPathTree& result, QueueType type){
+            Dijkstra(graph,start,result,type);
+        }
+        
+        // Single source -> target route by bidirectional Dijkstra
+        void ShortestPath(int source, int target, PathResult& result){
+            GetPointToPoint().BidirectionalDijkstra(source,target,result);
+        }
+        
+        // Single route by A* with an admissible heuristic h(v)
+        template<class Heuristic>
+        void ShortestPath(int source, int target, const Heuristic& h, PathResult& result){
+            GetPointToPoint().AStar(source,target,h,result);
+        }
+        
+        // Silent parallel query; delta <= 0 picks DeltaStepping::DefaultDelta
+        void ShortestPathsParallel(int start, ShortestPathTree& result, ThreadPool& pool, int delta){
+            if(delta<=0){
+                delta=DeltaStepping::DefaultDelta(graph);
+            }
+            DeltaStepping solver(graph,pool,delta);
+            solver.Run(start,result);
+        }
+        
+        // Silent query split over numProcesses processes by vertex range.
+        // Each worker maps its own part of the file the graph came from; a
+        // text file is converted to a temporary binary one first, so use a
+        // binary file for graphs too big for one process. No other thread
+        // may be running, since the workers are forked.
+        bool ShortestPathsPartitioned(int start, ShortestPathTree& result, int numProcesses){
+            return RunPartitioned(filename,start,numProcesses,result);
+        }
+        
+        // Teaching version: loads the file and prints every step
+        void DSP(int start, string filename){
+            if(!Load(filename)){
+                cout << "Error: Could not open file " << filename << endl;
+                return;
+            }
+            int size=graph.GetNumVertices();
+            if(start<0 || start>=size){
+                cout << "Error: Start vertex " << start << " is not in the graph" << endl;
+                return;
             }
             
+            PrintGraph();
+            ShortestPathTree result;
+            TraceObserver trace(graph);
+            Dijkstra(graph,start,result,trace);
+            
             // Print results
             cout << "\n=== FINAL RESULTS ===" << endl;
             cout << "+--------+----------+----------------------+" << endl;
             cout << "| Vertex | Distance | Path                 |" << endl;
             cout << "+--------+----------+----------------------+" << endl;
             
-            for(int i=0;i<matrix.size();i++){
-                Vertex* current=allVertices[i];
-                
-                cout << "|   " << current->vertexNum << "    |";
+            for(int i=0;i<size;i++){
+                cout << "|   " << i << "    |";
                 
                 // Handle unreachable vertices
-                if(current->distance==INF){
+                if(result.distance[i]==INF){
                     cout << "   INF    | No path              |" << endl;
                     continue;
                 }
 
                 // Print distance
-                cout << "    " << current->distance << "     | ";
-                
-                // Reconstruct path 
-                vector<Vertex*> path;
-                Vertex* temp = current;
+                cout << "    " << result.distance[i] << "     | ";
                 
                 // Build path from destination to source
-                while(temp != nullptr){
-                    path.push_back(temp);
-                    if(temp->vertexNum == start){
-                        break;   
-                    }
-                    temp = temp->predV;
+                vector<int> path;
+                for(int v=i;v!=-1;v=result.pred[v]){
+                    path.push_back(v);
                 }
                 
                 // Build path string
                 string pathStr = "";
                 for(int j=path.size()-1; j>=0; j--){
-                    pathStr += to_string(path[j]->vertexNum);
+                    pathStr += to_string(path[j]);
                     if(j>0){
                         pathStr += "->";   
                     }
@@ -365,12 +407,9 @@ class Graph{
                 cout << left << setw(20) << pathStr << " |" << endl;
             }
             cout << "+--------+----------+----------------------+" << endl;
-            
-            // Cleanup memory
-            for(Vertex* v : allVertices){
-                delete v;
+            if(result.saturated){
+                cout << "Warning: some path lengths do not fit in an int and are shown as INF" << endl;
             }
-            allVertices.clear();
         }
 };
 
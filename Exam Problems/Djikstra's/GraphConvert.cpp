@@ -0,0 +1,49 @@
+#include <iostream>
+#include <string>
+#include "CSRGraph.h"
+using namespace std;
+
+// Reads the text graph with Weight-typed weights and writes it as binary
+template<class Weight>
+int Convert(string input, string output){
+    BasicCSRGraph<Weight> graph;
+    if(!graph.LoadEdgeList(input)){
+        cout<<"Error: Could not read graph file "<<input<<endl;
+        return 1;
+    }
+    if(!graph.SaveBinary(output)){
+        cout<<"Error: Could not write "<<output<<endl;
+        return 1;
+    }
+    cout<<"Wrote "<<graph.GetNumVertices()<<" vertices and "<<graph.GetNumEdges()<<" edges to "<<output<<endl;
+    return 0;
+}
+
+// Converts a text edge list (vertex count, then "a b weight" triples)
+// into the binary CSR file that Graph::Load memory-maps. The weights are
+// stored as 32-bit ints unless another type is named.
+// Usage: GraphConvert input.txt output.bin [int32|int64|float|double]
+int main(int argc, char* argv[]){
+    string input;
+    string output;
+    string type="int32";
+    if(argc>=3){
+        input=argv[1];
+        output=argv[2];
+        if(argc>=4){
+            type=argv[3];
+        }
+    }
+    else{
+        cout<<"Enter text graph file: ";
+        cin>>input;
+        cout<<"Enter binary output file: ";
+        cin>>output;
+    }
+    if(type=="int32") return Convert<int>(input,output);
+    if(type=="int64") return Convert<long long>(input,output);
+    if(type=="float") return Convert<float>(input,output);
+    if(type=="double") return Convert<double>(input,output);
+    cout<<"Error: Unknown weight type "<<type<<endl;
+    return 1;
+}
@@ -0,0 +1,114 @@
+#ifndef GRAPHGENERATORS_H
+#define GRAPHGENERATORS_H
+
+#include <vector>
+#include <random>
+#include "CSRGraph.h"
+using namespace std;
+
+// Synthetic graphs for the benchmarks. Every generator is deterministic
+// for a given seed and draws weights uniformly from [1,maxWeight].
+
+// Erdos-Renyi style G(n,m): m directed edges with both ends uniform
+inline CSRGraph RandomGraph(int n, int m, int maxWeight, unsigned seed){
+    mt19937 rng(seed);
+    uniform_int_distribution<int> vertexDist(0,n-1);
+    uniform_int_distribution<int> weightDist(1,maxWeight);
+    vector<int> src(m);
+    vector<int> dst(m);
+    vector<int> w(m);
+    for(int i=0;i<m;i++){
+        src[i]=vertexDist(rng);
+        dst[i]=vertexDist(rng);
+        w[i]=weightDist(rng);
+    }
+    CSRGraph graph;
+    graph.Build(n,src,dst,w);
+    return graph;
+}
+
+// rows x cols grid with edges both ways between 4-neighbours
+inline CSRGraph GridGraph(int rows, int cols, int maxWeight, unsigned seed){
+    mt19937 rng(seed);
+    uniform_int_distribution<int> weightDist(1,maxWeight);
+    vector<int> src;
+    vector<int> dst;
+    vector<int> w;
+    for(int r=0;r<rows;r++){
+        for(int c=0;c<cols;c++){
+            int v=r*cols+c;
+            if(c+1<cols){
+                int weight=weightDist(rng);
+                src.push_back(v); dst.push_back(v+1); w.push_back(weight);
+                src.push_back(v+1); dst.push_back(v); w.push_back(weight);
+            }
+            if(r+1<rows){
+                int weight=weightDist(rng);
+                src.push_back(v); dst.push_back(v+cols); w.push_back(weight);
+                src.push_back(v+cols); dst.push_back(v); w.push_back(weight);
+            }
+        }
+    }
+    CSRGraph graph;
+    graph.Build(rows*cols,src,dst,w);
+    return graph;
+}
+
+// R-MAT power-law graph on 2^scale vertices (Chakrabarti et al.). Each
+// edge picks one quadrant of the adjacency matrix per bit with
+// probabilities a, b, c and 1-a-b-c; the defaults are the Graph500 ones.
+// Duplicate edges are merged, so slightly fewer than m remain.
+inline CSRGraph RMatGraph(int scale, int m, int maxWeight, unsigned seed, double a=0.57, double b=0.19, double c=0.19){
+    mt19937 rng(seed);
+    uniform_real_distribution<double> quadrant(0.0,1.0);
+    uniform_int_distribution<int> weightDist(1,maxWeight);
+    vector<int> src(m);
+    vector<int> dst(m);
+    vector<int> w(m);
+    for(int i=0;i<m;i++){
+        int u=0;
+        int v=0;
+        for(int bit=scale-1;bit>=0;bit--){
+            double r=quadrant(rng);
+            if(r<a){
+                continue;
+            }
+            if(r<a+b){
+                v|=1<<bit;
+            }
+            else if(r<a+b+c){
+                u|=1<<bit;
+            }
+            else{
+                u|=1<<bit;
+                v|=1<<bit;
+            }
+        }
+        src[i]=u;
+        dst[i]=v;
+        w[i]=weightDist(rng);
+    }
+    CSRGraph graph;
+    graph.Build(1<<scale,src,dst,w);
+    return graph;
+}
+
+// Path 0 - 1 - ... - n-1 with edges both ways: the deepest possible
+// search, one vertex in the queue at a time
+inline CSRGraph ChainGraph(int n, int maxWeight, unsigned seed){
+    mt19937 rng(seed);
+    uniform_int_distribution<int> weightDist(1,maxWeight);
+    vector<int> src;
+    vector<int> dst;
+    vector<int> w;
+    for(int v=0;v+1<n;v++){
+        int weight=weightDist(rng);
+        src.push_back(v); dst.push_back(v+1); w.push_back(weight);
+        src.push_back(v+1); dst.push_back(v); w.push_back(weight);
+    }
+    CSRGraph graph;
+    graph.Build(n,src,dst,w);
+    return graph;
+}
+
+#endif
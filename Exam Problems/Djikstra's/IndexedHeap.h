@@ -0,0 +1,178 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+using namespace std;
+
+class QueueException : public exception{
+    private:
+        string message;
+    public:
+        QueueException(const string& msg){
+            message=msg;
+        }
+        const char* what() const noexcept override{
+            return message.c_str();
+        }
+};
+
+// Min-heap of vertex numbers keyed by distance. Every vertex is in the
+// heap at most once and pos[] remembers where, so an improved distance
+// is a DecreaseKey instead of a duplicate entry. D is the arity and Key
+// the distance type.
+template<int D=4, class Key=int>
+class IndexedDHeap{
+    private:
+        struct Entry{
+            Key key;
+            int vertex;
+        };
+        int size;
+        vector<Entry> heap;
+        vector<int> pos;
+
+        void PercolateUp(int index){
+            Entry e=heap[index];
+            while(index>0){
+                int parentIndex=(index-1)/D;
+                if(e.key>=heap[parentIndex].key){
+                    break;
+                }
+                heap[index]=heap[parentIndex];
+                pos[heap[index].vertex]=index;
+                index=parentIndex;
+            }
+            heap[index]=e;
+            pos[e.vertex]=index;
+        }
+        void PercolateDown(int index){
+            Entry e=heap[index];
+            while(true){
+                int childIndex=index*D+1;
+                if(childIndex>=size){
+                    break;
+                }
+                int last=childIndex+D;
+                if(last>size){
+                    last=size;
+                }
+                int minIndex=childIndex;
+                for(int i=childIndex+1;i<last;i++){
+                    if(heap[i].key<heap[minIndex].key){
+                        minIndex=i;
+                    }
+                }
+                if(heap[minIndex].key>=e.key){
+                    break;
+                }
+                heap[index]=heap[minIndex];
+                pos[heap[index].vertex]=index;
+                index=minIndex;
+            }
+            heap[index]=e;
+            pos[e.vertex]=index;
+        }
+    public:
+        typedef Key KeyType;
+
+        IndexedDHeap(){
+            size=0;
+        }
+        // Sizes the arrays for vertices 0..n-1; call once per query
+        void Reset(int n){
+            size=0;
+            heap.resize(n);
+            pos.assign(n,-1);
+        }
+        // Empties the heap in O(entries left) when the size is unchanged,
+        // for searches that only touch a small part of the graph
+        void Clear(){
+            for(int i=0;i<size;i++){
+                pos[heap[i].vertex]=-1;
+            }
+            size=0;
+        }
+        int GetSize() const{
+            return size;
+        }
+        bool IsEmpty() const{
+            return size==0;
+        }
+        bool Contains(int v) const{
+            return pos[v]>=0;
+        }
+        Key GetKey(int v) const{
+            return heap[pos[v]].key;
+        }
+        Key TopKey() const{
+            if(size==0){
+                throw QueueException("Queue Is Empty");
+            }
+            return heap[0].key;
+        }
+        int Top() const{
+            if(size==0){
+                throw QueueException("Queue Is Empty");
+            }
+            return heap[0].vertex;
+        }
+        void Push(int v, Key key){
+            heap[size].key=key;
+            heap[size].vertex=v;
+            size++;
+            PercolateUp(size-1);
+        }
+        void DecreaseKey(int v, Key key){
+            int index=pos[v];
+            heap[index].key=key;
+            PercolateUp(index);
+        }
+        // Sets v's key to any value, moving it up or down as needed
+        void ChangeKey(int v, Key key){
+            int index=pos[v];
+            Key old=heap[index].key;
+            heap[index].key=key;
+            if(key<old){
+                PercolateUp(index);
+            }
+            else{
+                PercolateDown(index);
+            }
+        }
+        // Inserts v or lowers its key, whichever applies
+        void PushOrDecrease(int v, Key key){
+            if(pos[v]>=0){
+                DecreaseKey(v,key);
+            }
+            else{
+                Push(v,key);
+            }
+        }
+        int Pop(){
+            if(size==0){
+                throw QueueException("Queue Is Empty");
+            }
+            int v=heap[0].vertex;
+            pos[v]=-1;
+            size--;
+            if(size>0){
+                heap[0]=heap[size];
+                PercolateDown(0);
+            }
+            return v;
+        }
+
+        // Print contents of priority queue
+        void PrintQueue() const{
+            cout << "   Priority Queue: [";
+            for(int i = 0; i < size; i++){
+                cout << "V" << heap[i].vertex << "(d=" << heap[i].key << ")";
+                if(i < size - 1) cout << ", ";
+            }
+            cout << "]" << endl;
+        }
+};
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef PARTITIONEDSSSP_H
+#define PARTITIONEDSSSP_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "Transport.h"
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// One rank of a distributed delta-stepping search. Rank r owns the
+// vertices in [bounds[r], bounds[r+1]) and keeps only their out-edges and
+// distances, so no process ever holds the whole graph. In each round all
+// ranks work on the same bucket of width delta. A rank empties its share
+// of the bucket locally, applying relaxations into its own range at once
+// until nothing changes, and batches relaxations into other ranges. The
+// batches go out in one Exchange per round. Each message also carries the
+// lowest bucket its sender still has work in or sent requests for, so
+// the ranks agree on the next bucket without a separate reduction.
+// Every edge of a vertex is relaxed when it leaves the bucket. Edges
+// heavier than delta only reach later buckets, so relaxing them early
+// costs at most a repeat if the vertex re-enters this bucket.
+class PartitionedShortestPaths{
+    private:
+        struct Request{
+            int vertex;
+            int distance;
+            int pred;
+        };
+
+        Transport& transport;
+        int rank;
+        int numRanks;
+        int numVertices=0;
+        vector<int> bounds;
+        int first=0;
+        int last=0;
+
+        // Out-edges of the owned vertices, offsets rebased to 0
+        vector<int> offsets;
+        vector<int> targets;
+        vector<int> weights;
+
+        int delta=1;
+        int numBuckets=2;
+        vector<int> distance;
+        vector<int> pred;
+        // Absolute bucket a vertex is queued in, or -1
+        vector<long long> bucketOf;
+        vector<vector<int>> buckets;
+        vector<vector<Request>> outgoing;
+        long long sentBucket=LLONG_MAX;
+        vector<vector<char>> sendBuffers;
+        vector<vector<char>> receiveBuffers;
+        long long remoteRequests=0;
+        int rounds=0;
+        // Some sum on this rank saturated at INF in the last Run
+        bool saturated=false;
+
+        int Owner(int v) const{
+            return (int)(upper_bound(bounds.begin(),bounds.end(),v)-bounds.begin())-1;
+        }
+
+        // Splits the vertices into ranges with about equal vertices + edges
+        void ComputeBounds(const CSRGraph& graph){
+            long long total=(long long)graph.GetNumVertices()+graph.GetNumEdges();
+            bounds.assign(numRanks+1,numVertices);
+            bounds[0]=0;
+            int v=0;
+            for(int r=1;r<numRanks;r++){
+                long long goal=total*r/numRanks;
+                while(v<numVertices && (long long)v+graph.offsets[v]<goal){
+                    v++;
+                }
+                bounds[r]=v;
+            }
+        }
+
+        void Offer(int v, int d, int p){
+            int i=v-first;
+            if(d>=distance[i]){
+                return;
+            }
+            distance[i]=d;
+            pred[i]=p;
+            long long b=d/delta;
+            if(bucketOf[i]!=b){
+                bucketOf[i]=b;
+                buckets[b%numBuckets].push_back(i);
+            }
+        }
+
+        void Relax(int i){
+            int u=first+i;
+            int du=distance[i];
+            for(int e=offsets[i];e<offsets[i+1];e++){
+                int v=targets[e];
+                int alt=WeightTraits<int>::Add(du,weights[e],saturated);
+                if(alt==INF){
+                    continue;
+                }
+                if(v>=first && v<last){
+                    Offer(v,alt,u);
+                }
+                else{
+                    outgoing[Owner(v)].push_back({v,alt,u});
+                    sentBucket=min(sentBucket,(long long)(alt/delta));
+                }
+            }
+        }
+
+        // Delivers the batched remote relaxations with this rank's next
+        // bucket, applies what arrives and returns the lowest next bucket
+        // of any rank. A request that turns out not to improve anything can
+        // make that bucket empty, which only costs one idle round.
+        long long ExchangeRequests(long long candidate){
+            for(int r=0;r<numRanks;r++){
+                vector<Request>& batch=outgoing[r];
+                remoteRequests+=batch.size();
+                vector<char>& out=sendBuffers[r];
+                out.resize(sizeof(candidate)+batch.size()*sizeof(Request));
+                memcpy(out.data(),&candidate,sizeof(candidate));
+                if(!batch.empty()){
+                    memcpy(out.data()+sizeof(candidate),batch.data(),batch.size()*sizeof(Request));
+                }
+                batch.clear();
+            }
+            transport.Exchange(sendBuffers,receiveBuffers);
+            rounds++;
+            long long next=candidate;
+            for(int r=0;r<numRanks;r++){
+                if(r==rank){
+                    continue;
+                }
+                const vector<char>& in=receiveBuffers[r];
+                long long other;
+                memcpy(&other,in.data(),sizeof(other));
+                next=min(next,other);
+                int count=(int)((in.size()-sizeof(other))/sizeof(Request));
+                for(int k=0;k<count;k++){
+                    Request q;
+                    memcpy(&q,in.data()+sizeof(other)+k*sizeof(Request),sizeof(Request));
+                    Offer(q.vertex,q.distance,q.pred);
+                }
+            }
+            return next;
+        }
+
+        // Drops stale entries from bucket index's slot; true if any remain
+        bool HasLive(long long index){
+            vector<int>& slot=buckets[index%numBuckets];
+            int kept=0;
+            for(int i : slot){
+                if(bucketOf[i]==index){
+                    slot[kept++]=i;
+                }
+            }
+            slot.resize(kept);
+            return kept>0;
+        }
+
+        long long NextLocalBucket(long long from){
+            for(int k=0;k<numBuckets;k++){
+                if(HasLive(from+k)){
+                    return from+k;
+                }
+            }
+            return LLONG_MAX;
+        }
+
+    public:
+        PartitionedShortestPaths(Transport& t) : transport(t){
+            rank=t.GetRank();
+            numRanks=t.GetNumRanks();
+        }
+
+        // Every rank maps the same binary CSR file and copies just its own
+        // rows, so only those rows and the offsets are paged in. A text
+        // edge list would have to be parsed whole by every rank, so it is
+        // refused; RunPartitioned converts one first.
+        // Collective: false on every rank if any rank failed.
+        bool Load(string filename){
+            CSRGraph graph;
+            bool ok=CSRGraph::IsBinaryFile(filename) && graph.MapBinary(filename);
+            if(transport.AllReduce(ok ? 1 : 0,ReduceOp::Min)==0){
+                return false;
+            }
+            numVertices=graph.GetNumVertices();
+            ComputeBounds(graph);
+            first=bounds[rank];
+            last=bounds[rank+1];
+            int begin=graph.offsets[first];
+            int end=graph.offsets[last];
+            offsets.resize(last-first+1);
+            for(int v=first;v<=last;v++){
+                offsets[v-first]=graph.offsets[v]-begin;
+            }
+            targets.assign(graph.targets+begin,graph.targets+end);
+            weights.assign(graph.weights+begin,graph.weights+end);
+
+            // Same rule as DeltaStepping::DefaultDelta over the whole graph
+            long long maxWeight=1;
+            for(int w : weights){
+                maxWeight=max(maxWeight,(long long)w);
+            }
+            maxWeight=transport.AllReduce(maxWeight,ReduceOp::Max);
+            double avgDegree=numVertices>0 ? (double)graph.GetNumEdges()/numVertices : 0;
+            delta=(int)(maxWeight/(avgDegree>1 ? avgDegree : 1));
+            delta=delta<1 ? 1 : delta;
+            numBuckets=(int)(maxWeight/delta)+2;
+            return true;
+        }
+
+        int GetNumVertices() const{
+            return numVertices;
+        }
+        int GetFirst() const{
+            return first;
+        }
+        int GetLast() const{
+            return last;
+        }
+        // Relaxations sent to other ranks and Exchange rounds in the last Run
+        long long GetRemoteRequests() const{
+            return remoteRequests;
+        }
+        int GetRounds() const{
+            return rounds;
+        }
+
+        // Collective. Afterwards each rank holds the distances of its range.
+        void Run(int source){
+            int size=last-first;
+            distance.assign(size,INF);
+            pred.assign(size,-1);
+            bucketOf.assign(size,-1);
+            buckets.assign(numBuckets,vector<int>());
+            outgoing.assign(numRanks,vector<Request>());
+            sendBuffers.assign(numRanks,vector<char>());
+            sentBucket=LLONG_MAX;
+            remoteRequests=0;
+            rounds=0;
+            saturated=false;
+            if(source>=first && source<last){
+                Offer(source,0,-1);
+            }
+
+            // Only the source's owner has work in bucket 0, but every rank
+            // starts there so they all agree without a first exchange
+            long long index=0;
+            vector<int> current;
+            while(index!=LLONG_MAX){
+                vector<int>& slot=buckets[index%numBuckets];
+                while(!slot.empty()){
+                    current.clear();
+                    current.swap(slot);
+                    for(int i : current){
+                        if(bucketOf[i]!=index){
+                            continue;
+                        }
+                        bucketOf[i]=-1;
+                        Relax(i);
+                    }
+                }
+                long long candidate=min(NextLocalBucket(index),sentBucket);
+                sentBucket=LLONG_MAX;
+                index=ExchangeRequests(candidate);
+            }
+        }
+
+        // Collective. Rank 0 receives the whole tree; other ranks' result
+        // is left untouched.
+        void Gather(int source, ShortestPathTree& result){
+            int size=last-first;
+            for(int r=0;r<numRanks;r++){
+                sendBuffers[r].clear();
+            }
+            if(rank!=0){
+                vector<char>& out=sendBuffers[0];
+                out.resize(2*sizeof(int)*size+1);
+                memcpy(out.data(),distance.data(),sizeof(int)*size);
+                memcpy(out.data()+sizeof(int)*size,pred.data(),sizeof(int)*size);
+                out.back()=saturated ? 1 : 0;
+            }
+            transport.Exchange(sendBuffers,receiveBuffers);
+            if(rank!=0){
+                return;
+            }
+            result.source=source;
+            result.saturated=saturated;
+            result.distance.assign(numVertices,INF);
+            result.pred.assign(numVertices,-1);
+            copy(distance.begin(),distance.end(),result.distance.begin()+first);
+            copy(pred.begin(),pred.end(),result.pred.begin()+first);
+            for(int r=1;r<numRanks;r++){
+                int count=bounds[r+1]-bounds[r];
+                const char* in=receiveBuffers[r].data();
+                memcpy(result.distance.data()+bounds[r],in,sizeof(int)*count);
+                memcpy(result.pred.data()+bounds[r],in+sizeof(int)*count,sizeof(int)*count);
+                if(in[2*sizeof(int)*count]!=0){
+                    result.saturated=true;
+                }
+            }
+        }
+};
+
+// Solves from source over numProcesses processes on this machine: this
+// process is rank 0 and forks the rest, which talk over Unix sockets.
+// A text edge list is first converted to a temporary binary file, which
+// takes the whole graph in this process once; pass a binary file (see
+// GraphConvert) to keep every process down to its own range.
+// Returns false if the file cannot be loaded, the source is not in the
+// graph, or a worker fails. The caller must have no other threads
+// running: a forked child only gets the forking thread, and a lock
+// another thread held stays locked in it.
+inline bool RunPartitioned(string filename, int source, int numProcesses, ShortestPathTree& result){
+#ifdef _WIN32
+    return false;
+#else
+    if(numProcesses<1){
+        return false;
+    }
+    string converted;
+    if(!CSRGraph::IsBinaryFile(filename)){
+        CSRGraph graph;
+        char path[]="/tmp/partitionedXXXXXX";
+        int fd=mkstemp(path);
+        if(fd<0){
+            return false;
+        }
+        close(fd);
+        converted=path;
+        if(!graph.LoadEdgeList(filename) || !graph.SaveBinary(converted)){
+            remove(converted.c_str());
+            return false;
+        }
+        filename=converted;
+    }
+    SocketTransport transport(numProcesses);
+    cout.flush();
+    cerr.flush();
+    vector<pid_t> children;
+    for(int r=1;r<numProcesses;r++){
+        pid_t pid=fork();
+        if(pid<0){
+            break;
+        }
+        if(pid==0){
+            int status=1;
+            try{
+                transport.Bind(r);
+                PartitionedShortestPaths worker(transport);
+                if(worker.Load(filename) && source>=0 && source<worker.GetNumVertices()){
+                    worker.Run(source);
+                    ShortestPathTree unused;
+                    worker.Gather(source,unused);
+                    status=0;
+                }
+            }
+            catch(const exception& e){
+                cerr << "Rank " << r << ": " << e.what() << endl;
+            }
+            _exit(status);
+        }
+        children.push_back(pid);
+    }
+
+    bool ok=(int)children.size()==numProcesses-1;
+    if(ok){
+        try{
+            transport.Bind(0);
+            PartitionedShortestPaths worker(transport);
+            ok=worker.Load(filename) && source>=0 && source<worker.GetNumVertices();
+            if(ok){
+                worker.Run(source);
+                worker.Gather(source,result);
+            }
+        }
+        catch(const exception& e){
+            cerr << "Rank 0: " << e.what() << endl;
+            ok=false;
+        }
+    }
+    // Closing rank 0's sockets wakes any worker still waiting on it
+    transport.Close();
+    for(pid_t pid : children){
+        int status;
+        waitpid(pid,&status,0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status)!=0){
+            ok=false;
+        }
+    }
+    if(!converted.empty()){
+        remove(converted.c_str());
+    }
+    return ok;
+#endif
+}
+
+#endif
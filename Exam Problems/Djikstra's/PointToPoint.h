@@ -0,0 +1,249 @@
+#ifndef POINTTOPOINT_H
+#define POINTTOPOINT_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include "CSRGraph.h"
+#include "Dijkstra.h"
+#include "IndexedHeap.h"
+using namespace std;
+
+// Answer to a source -> target query. distance is INF and path is empty
+// when target cannot be reached. settledVertices counts heap pops over
+// both directions, i.e. how much of the graph the query explored.
+// saturated is set when some path was too long for an int, as in
+// BasicShortestPathTree.
+struct PathResult{
+    int distance=INF;
+    vector<int> path;
+    int settledVertices=0;
+    bool saturated=false;
+
+    // Keeps the path's capacity so reused results do not reallocate
+    void Clear(){
+        distance=INF;
+        path.clear();
+        settledVertices=0;
+        saturated=false;
+    }
+};
+
+// A* heuristic from planar coordinates: scale * straight-line distance to
+// the target. It is admissible as long as no edge of length L (in
+// coordinate units) weighs less than scale * L.
+class EuclideanHeuristic{
+    private:
+        const vector<double>& x;
+        const vector<double>& y;
+        double scale;
+        int target;
+    public:
+        EuclideanHeuristic(const vector<double>& xs, const vector<double>& ys, double s, int t) : x(xs), y(ys){
+            scale=s;
+            target=t;
+        }
+        int operator()(int v) const{
+            double dx=x[v]-x[target];
+            double dy=y[v]-y[target];
+            return (int)(scale*sqrt(dx*dx+dy*dy));
+        }
+};
+
+// Reads "v x y" lines into coordinate arrays sized for numVertices
+inline bool LoadCoordinates(string filename, int numVertices, vector<double>& x, vector<double>& y){
+    ifstream input(filename);
+    if(!input.is_open()){
+        return false;
+    }
+    x.assign(numVertices,0);
+    y.assign(numVertices,0);
+    int v;
+    double vx;
+    double vy;
+    while(input>>v>>vx>>vy){
+        if(v<0 || v>=numVertices){
+            return false;
+        }
+        x[v]=vx;
+        y[v]=vy;
+    }
+    return true;
+}
+
+class PointToPointSearch{
+    private:
+        // One direction of a search. dist and pred only count for vertices
+        // stamped with the current round, so starting a query costs
+        // O(vertices the last query touched), as in BasicDijkstraWorkspace.
+        struct Side{
+            IndexedDHeap<> queue;
+            vector<int> dist;
+            vector<int> pred;
+            vector<unsigned> stamp;
+
+            int Distance(int v, unsigned round) const{
+                return stamp[v]==round ? dist[v] : INF;
+            }
+            int Pred(int v, unsigned round) const{
+                return stamp[v]==round ? pred[v] : -1;
+            }
+            void Set(int v, int d, int p, unsigned round){
+                stamp[v]=round;
+                dist[v]=d;
+                pred[v]=p;
+            }
+        };
+
+        const CSRGraph& forward;
+        CSRGraph ownedBackward;
+        const CSRGraph& backward;
+        Side forwardSide;
+        Side backwardSide;
+        unsigned round=0;
+
+        // Sizes the arrays on first use, then only empties the queues
+        void Begin(){
+            int n=forward.GetNumVertices();
+            Side* sides[2]={&forwardSide,&backwardSide};
+            if((int)forwardSide.stamp.size()!=n){
+                for(Side* side : sides){
+                    side->dist.resize(n);
+                    side->pred.resize(n);
+                    side->stamp.assign(n,0);
+                    side->queue.Reset(n);
+                }
+                round=0;
+            }
+            else{
+                forwardSide.queue.Clear();
+                backwardSide.queue.Clear();
+            }
+            round++;
+            if(round==0){
+                // The counter wrapped, so old stamps could match again
+                for(Side* side : sides){
+                    fill(side->stamp.begin(),side->stamp.end(),0);
+                }
+                round=1;
+            }
+        }
+
+        // Settles the top of one side and relaxes its edges, updating the
+        // best meeting point seen so far. Sums go through WeightTraits::Add,
+        // so a path too long for an int saturates at INF instead of wrapping.
+        void Step(const CSRGraph& graph, Side& side, const Side& other, int& best, int& meet, bool& saturated){
+            int u=side.queue.Pop();
+            int du=side.dist[u];
+            for(int e=graph.EdgeBegin(u);e<graph.EdgeEnd(u);e++){
+                int v=graph.targets[e];
+                int alt=WeightTraits<int>::Add(du,graph.weights[e],saturated);
+                int dv=side.Distance(v,round);
+                if(alt<dv){
+                    dv=alt;
+                    side.Set(v,alt,u,round);
+                    side.queue.PushOrDecrease(v,alt);
+                }
+                int otherDv=other.Distance(v,round);
+                if(dv!=INF && otherDv!=INF){
+                    int through=WeightTraits<int>::Add(dv,otherDv,saturated);
+                    if(through<best){
+                        best=through;
+                        meet=v;
+                    }
+                }
+            }
+        }
+
+    public:
+        PointToPointSearch(const CSRGraph& graph) : forward(graph), ownedBackward(graph.Reversed()), backward(ownedBackward){
+        }
+        // Shares a reversed graph built elsewhere, e.g. one per worker thread
+        PointToPointSearch(const CSRGraph& graph, const CSRGraph& reversed) : forward(graph), backward(reversed){
+        }
+
+        // Bidirectional Dijkstra. Stops once the two queue minimums add up
+        // to at least the best path found, since no better one can remain.
+        void BidirectionalDijkstra(int source, int target, PathResult& result){
+            result.Clear();
+            Begin();
+            IndexedDHeap<>& forwardQueue=forwardSide.queue;
+            IndexedDHeap<>& backwardQueue=backwardSide.queue;
+
+            forwardSide.Set(source,0,-1,round);
+            backwardSide.Set(target,0,-1,round);
+            forwardQueue.Push(source,0);
+            backwardQueue.Push(target,0);
+            int best=source==target ? 0 : INF;
+            int meet=source==target ? source : -1;
+
+            while(!forwardQueue.IsEmpty() && !backwardQueue.IsEmpty()){
+                long long lower=(long long)forwardQueue.TopKey()+backwardQueue.TopKey();
+                if(lower>=best){
+                    break;
+                }
+                result.settledVertices++;
+                if(forwardQueue.GetSize()<=backwardQueue.GetSize()){
+                    Step(forward,forwardSide,backwardSide,best,meet,result.saturated);
+                }
+                else{
+                    Step(backward,backwardSide,forwardSide,best,meet,result.saturated);
+                }
+            }
+
+            if(meet==-1){
+                return;
+            }
+            result.distance=best;
+            for(int v=meet;v!=-1;v=forwardSide.Pred(v,round)){
+                result.path.push_back(v);
+            }
+            reverse(result.path.begin(),result.path.end());
+            for(int v=backwardSide.Pred(meet,round);v!=-1;v=backwardSide.Pred(v,round)){
+                result.path.push_back(v);
+            }
+        }
+
+        // A* with a caller-supplied admissible heuristic h(v). Vertices may
+        // be reopened, so an admissible but inconsistent h is still exact.
+        template<class Heuristic>
+        void AStar(int source, int target, const Heuristic& h, PathResult& result){
+            result.Clear();
+            Begin();
+            IndexedDHeap<>& queue=forwardSide.queue;
+
+            forwardSide.Set(source,0,-1,round);
+            queue.Push(source,h(source));
+            while(!queue.IsEmpty()){
+                int u=queue.Pop();
+                result.settledVertices++;
+                if(u==target){
+                    break;
+                }
+                int du=forwardSide.dist[u];
+                for(int e=forward.EdgeBegin(u);e<forward.EdgeEnd(u);e++){
+                    int v=forward.targets[e];
+                    int alt=WeightTraits<int>::Add(du,forward.weights[e],result.saturated);
+                    if(alt<forwardSide.Distance(v,round)){
+                        forwardSide.Set(v,alt,u,round);
+                        // The key only orders the queue, so clamp it quietly
+                        bool clamped=false;
+                        queue.PushOrDecrease(v,WeightTraits<int>::Add(alt,h(v),clamped));
+                    }
+                }
+            }
+
+            int distance=forwardSide.Distance(target,round);
+            if(distance==INF){
+                return;
+            }
+            result.distance=distance;
+            for(int v=target;v!=-1;v=forwardSide.Pred(v,round)){
+                result.path.push_back(v);
+            }
+            reverse(result.path.begin(),result.path.end());
+        }
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+
+#include <vector>
+#include "IndexedHeap.h"
+using namespace std;
+
+// Monotone radix heap with decrease-key. Only valid when no key smaller
+// than the last popped key is ever inserted, which holds for Dijkstra.
+// Bucket 0 holds keys equal to the last popped key and bucket b > 0 holds
+// keys whose highest bit differing from it is bit b-1. Each key moves to
+// a lower bucket at most 32 times, so operations are O(1) amortized plus
+// O(log C) for the pop that refills bucket 0, with no comparisons of keys
+// against each other except inside that refill.
+class RadixHeap{
+    private:
+        static const int NUM_BUCKETS=33;
+        int size;
+        unsigned last;
+        vector<int> buckets[NUM_BUCKETS];
+        vector<unsigned> key;
+        vector<int> bucketOf;
+        vector<int> pos;
+
+        int BucketFor(unsigned k) const{
+            if(k==last){
+                return 0;
+            }
+            return 32-__builtin_clz(k^last);
+        }
+        void Insert(int v, unsigned k){
+            int b=BucketFor(k);
+            key[v]=k;
+            bucketOf[v]=b;
+            pos[v]=(int)buckets[b].size();
+            buckets[b].push_back(v);
+        }
+        void Remove(int v){
+            vector<int>& bucket=buckets[bucketOf[v]];
+            int moved=bucket.back();
+            bucket[pos[v]]=moved;
+            pos[moved]=pos[v];
+            bucket.pop_back();
+        }
+    public:
+        typedef int KeyType;
+
+        RadixHeap(){
+            size=0;
+            last=0;
+        }
+        void Reset(int n){
+            size=0;
+            last=0;
+            for(int b=0;b<NUM_BUCKETS;b++){
+                buckets[b].clear();
+            }
+            key.resize(n);
+            bucketOf.resize(n);
+            pos.assign(n,-1);
+        }
+        // Empties the heap in O(entries left) when the size is unchanged
+        void Clear(){
+            for(int b=0;b<NUM_BUCKETS;b++){
+                for(int v : buckets[b]){
+                    pos[v]=-1;
+                }
+                buckets[b].clear();
+            }
+            size=0;
+            last=0;
+        }
+        int GetSize() const{
+            return size;
+        }
+        bool IsEmpty() const{
+            return size==0;
+        }
+        bool Contains(int v) const{
+            return pos[v]>=0;
+        }
+        void Push(int v, int k){
+            Insert(v,(unsigned)k);
+            size++;
+        }
+        void DecreaseKey(int v, int k){
+            Remove(v);
+            Insert(v,(unsigned)k);
+        }
+        void PushOrDecrease(int v, int k){
+            if(pos[v]>=0){
+                DecreaseKey(v,k);
+            }
+            else{
+                Push(v,k);
+            }
+        }
+        int Pop(){
+            if(size==0){
+                throw QueueException("Queue Is Empty");
+            }
+            if(buckets[0].empty()){
+                // Refill bucket 0 from the first non-empty bucket: its
+                // smallest key becomes last and the rest spread out below
+                int b=1;
+                while(buckets[b].empty()){
+                    b++;
+                }
+                unsigned smallest=key[buckets[b][0]];
+                for(int v : buckets[b]){
+                    if(key[v]<smallest){
+                        smallest=key[v];
+                    }
+                }
+                last=smallest;
+                vector<int> moving;
+                moving.swap(buckets[b]);
+                for(int v : moving){
+                    Insert(v,key[v]);
+                }
+                moving.clear();
+                moving.swap(buckets[b]);
+            }
+            int v=buckets[0].back();
+            buckets[0].pop_back();
+            pos[v]=-1;
+            size--;
+            return v;
+        }
+};
+
+#endif
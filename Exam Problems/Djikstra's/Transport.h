@@ -0,0 +1,250 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <exception>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+using namespace std;
+
+class TransportException : public exception{
+    private:
+        string message;
+    public:
+        TransportException(const string& msg){
+            message=msg;
+        }
+        const char* what() const noexcept override{
+            return message.c_str();
+        }
+};
+
+enum class ReduceOp{
+    Min,
+    Max,
+    Sum
+};
+
+// Message passing between the ranks 0..N-1 of a partitioned computation.
+// Everything is collective: every rank calls Exchange the same number of
+// times, and each call hands one (possibly empty) message to every other
+// rank and returns one from each.
+class Transport{
+    public:
+        virtual ~Transport(){}
+        virtual int GetRank() const=0;
+        virtual int GetNumRanks() const=0;
+        // outgoing[r] goes to rank r and incoming[r] is what rank r sent
+        // here; the entries for this rank itself are ignored and left empty
+        virtual void Exchange(const vector<vector<char>>& outgoing, vector<vector<char>>& incoming)=0;
+
+        long long AllReduce(long long value, ReduceOp op){
+            int n=GetNumRanks();
+            vector<vector<char>> outgoing(n,vector<char>(sizeof(value)));
+            for(vector<char>& message : outgoing){
+                memcpy(message.data(),&value,sizeof(value));
+            }
+            vector<vector<char>> incoming;
+            Exchange(outgoing,incoming);
+            long long result=value;
+            for(int r=0;r<n;r++){
+                if(r==GetRank()){
+                    continue;
+                }
+                long long other;
+                memcpy(&other,incoming[r].data(),sizeof(other));
+                if(op==ReduceOp::Min) result=other<result ? other : result;
+                else if(op==ReduceOp::Max) result=other>result ? other : result;
+                else result+=other;
+            }
+            return result;
+        }
+};
+
+#ifndef _WIN32
+// Transport over a full mesh of Unix socket pairs for processes on one
+// machine. Create it before forking, then call Bind(rank) in each
+// process. Messages are framed with an 8-byte length. Exchange polls all
+// peers at once and sends and receives as each socket allows, so no pair
+// of ranks can block each other however large the batches get.
+class SocketTransport : public Transport{
+    private:
+        int rank=-1;
+        int numRanks;
+        // fds[a][b] is a's end of the a-b socket pair
+        vector<vector<int>> fds;
+
+        struct Progress{
+            const char* data;
+            size_t length;
+            size_t done;
+            char header[8];
+            size_t headerDone;
+        };
+
+        static void CloseAll(vector<vector<int>>& fds){
+            for(vector<int>& row : fds){
+                for(int& fd : row){
+                    if(fd>=0){
+                        close(fd);
+                        fd=-1;
+                    }
+                }
+            }
+        }
+
+    public:
+        SocketTransport(int n) : numRanks(n), fds(n,vector<int>(n,-1)){
+            for(int a=0;a<n;a++){
+                for(int b=a+1;b<n;b++){
+                    int pair[2];
+                    if(socketpair(AF_UNIX,SOCK_STREAM,0,pair)!=0){
+                        CloseAll(fds);
+                        throw TransportException("socketpair failed");
+                    }
+                    fds[a][b]=pair[0];
+                    fds[b][a]=pair[1];
+                }
+            }
+        }
+        ~SocketTransport(){
+            CloseAll(fds);
+        }
+        SocketTransport(const SocketTransport&)=delete;
+        SocketTransport& operator=(const SocketTransport&)=delete;
+
+        // Keeps this rank's ends of the pairs and closes every other fd
+        void Bind(int r){
+            rank=r;
+            for(int a=0;a<numRanks;a++){
+                for(int b=0;b<numRanks;b++){
+                    if(a!=r && fds[a][b]>=0){
+                        close(fds[a][b]);
+                        fds[a][b]=-1;
+                    }
+                }
+            }
+            for(int b=0;b<numRanks;b++){
+                if(fds[r][b]>=0){
+                    fcntl(fds[r][b],F_SETFL,fcntl(fds[r][b],F_GETFL)|O_NONBLOCK);
+                }
+            }
+        }
+        // Closes every socket; peers still waiting on this rank then fail
+        // instead of blocking forever
+        void Close(){
+            CloseAll(fds);
+        }
+        int GetRank() const override{
+            return rank;
+        }
+        int GetNumRanks() const override{
+            return numRanks;
+        }
+
+        void Exchange(const vector<vector<char>>& outgoing, vector<vector<char>>& incoming) override{
+            incoming.assign(numRanks,vector<char>());
+            vector<Progress> sending(numRanks);
+            vector<Progress> receiving(numRanks);
+            int open=0;
+            for(int r=0;r<numRanks;r++){
+                if(r==rank){
+                    continue;
+                }
+                uint64_t length=outgoing[r].size();
+                sending[r]={outgoing[r].data(),outgoing[r].size(),0,{},0};
+                memcpy(sending[r].header,&length,8);
+                receiving[r]={nullptr,0,0,{},0};
+                open+=2;
+            }
+
+            vector<pollfd> polls;
+            vector<int> peers;
+            while(open>0){
+                polls.clear();
+                peers.clear();
+                for(int r=0;r<numRanks;r++){
+                    if(r==rank){
+                        continue;
+                    }
+                    Progress& s=sending[r];
+                    Progress& in=receiving[r];
+                    short events=0;
+                    if(s.headerDone<8 || s.done<s.length) events|=POLLOUT;
+                    if(in.headerDone<8 || in.done<in.length) events|=POLLIN;
+                    if(events){
+                        polls.push_back({fds[rank][r],events,0});
+                        peers.push_back(r);
+                    }
+                }
+                if(poll(polls.data(),polls.size(),-1)<0){
+                    if(errno==EINTR){
+                        continue;
+                    }
+                    throw TransportException("poll failed");
+                }
+                for(int i=0;i<(int)polls.size();i++){
+                    int r=peers[i];
+                    int fd=polls[i].fd;
+                    Progress& s=sending[r];
+                    Progress& in=receiving[r];
+                    bool sendOpen=s.headerDone<8 || s.done<s.length;
+                    bool receiveOpen=in.headerDone<8 || in.done<in.length;
+                    if(sendOpen && (polls[i].revents&POLLOUT)){
+                        bool inHeader=s.headerDone<8;
+                        const char* from=inHeader ? s.header+s.headerDone : s.data+s.done;
+                        size_t left=inHeader ? 8-s.headerDone : s.length-s.done;
+                        ssize_t sent=send(fd,from,left,MSG_NOSIGNAL);
+                        if(sent<0 && errno!=EAGAIN && errno!=EINTR){
+                            throw TransportException("send to rank "+to_string(r)+" failed");
+                        }
+                        if(sent>0){
+                            if(inHeader) s.headerDone+=sent;
+                            else s.done+=sent;
+                        }
+                        if(s.headerDone==8 && s.done==s.length){
+                            open--;
+                        }
+                    }
+                    if(receiveOpen && (polls[i].revents&(POLLIN|POLLHUP|POLLERR))){
+                        bool inHeader=in.headerDone<8;
+                        char* to=inHeader ? in.header+in.headerDone : incoming[r].data()+in.done;
+                        size_t left=inHeader ? 8-in.headerDone : in.length-in.done;
+                        ssize_t got=recv(fd,to,left,0);
+                        if(got==0 || (got<0 && errno!=EAGAIN && errno!=EINTR)){
+                            throw TransportException("rank "+to_string(r)+" closed the connection");
+                        }
+                        if(got>0){
+                            if(inHeader){
+                                in.headerDone+=got;
+                                if(in.headerDone==8){
+                                    uint64_t length;
+                                    memcpy(&length,in.header,8);
+                                    in.length=length;
+                                    incoming[r].resize(length);
+                                }
+                            }
+                            else{
+                                in.done+=got;
+                            }
+                        }
+                        if(in.headerDone==8 && in.done==in.length){
+                            open--;
+                        }
+                    }
+                }
+            }
+        }
+};
+#endif
+
+#endif
@@ -2,11 +2,237 @@
 #include <fstream>
 #include <sstream>
 #include "Graph.h"
+#include "BatchQuery.h"
+#include "ContractionHierarchy.h"
+#include "DynamicSSSP.h"
+#include "PartitionedSSSP.h"
 #include <vector>
 #include <string>
+#include <thread>
+#include <cstdlib>
+#include <chrono>
+#include <iomanip>
+#include <limits>
 using namespace std;
 
-int main() {
+// Batch mode: load the graph once, then answer every query from the query
+// file (or stdin) on a pool of threads. Answers go to stdout, one line
+// per query: "s t distance", or "s reached=N farthest=D" for a source
+// alone. The throughput/latency report goes to stderr.
+int RunBatch(string graphFile, string queryFile, int threads){
+   CSRGraph graph;
+   if(!graph.Load(graphFile)){
+      cerr<<"Error: Could not open file "<<graphFile<<endl;
+      return 1;
+   }
+   ThreadPool pool(threads);
+   BatchQueryServer server(graph,pool);
+   vector<Query> queries;
+   if(queryFile=="-"){
+      server.ReadQueries(cin,queries);
+   }
+   else{
+      ifstream input(queryFile);
+      if(!input.is_open()){
+         cerr<<"Error: Could not open file "<<queryFile<<endl;
+         return 1;
+      }
+      server.ReadQueries(input,queries);
+   }
+   vector<QueryAnswer> answers;
+   BatchReport report=server.Run(queries,answers);
+   BatchQueryServer::PrintAnswers(cout,queries,answers);
+   BatchQueryServer::PrintReport(cerr,report);
+   return 0;
+}
+
+// Builds a contraction hierarchy for the graph and saves it to indexFile
+int BuildHierarchy(string graphFile, string indexFile){
+   CSRGraph graph;
+   if(!graph.Load(graphFile)){
+      cerr<<"Error: Could not open file "<<graphFile<<endl;
+      return 1;
+   }
+   auto begin=chrono::steady_clock::now();
+   ContractionHierarchy ch;
+   ch.Build(graph);
+   double seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+   if(!ch.Save(indexFile)){
+      cerr<<"Error: Could not write "<<indexFile<<endl;
+      return 1;
+   }
+   cout<<"Preprocessing time: "<<seconds<<" s"<<endl;
+   cout<<"Shortcuts added: "<<ch.GetNumShortcuts()<<endl;
+   cout<<"Index size: "<<ch.IndexBytes()<<" bytes"<<endl;
+   return 0;
+}
+
+// Answers "s t" lines from stdin with a saved contraction hierarchy
+int QueryHierarchy(string indexFile){
+   ContractionHierarchy ch;
+   if(!ch.Load(indexFile)){
+      cerr<<"Error: Could not read index "<<indexFile<<endl;
+      return 1;
+   }
+   int s;
+   int t;
+   while(cin>>s>>t){
+      if(s<0 || t<0 || s>=ch.GetNumVertices() || t>=ch.GetNumVertices()){
+         cerr<<"Skipping query with unknown vertex: "<<s<<" "<<t<<endl;
+         continue;
+      }
+      int d=ch.Query(s,t);
+      cout<<s<<" "<<t<<" ";
+      if(d==INF) cout<<"INF";
+      else cout<<d;
+      cout<<"\n";
+   }
+   return 0;
+}
+
+// Keeps shortest paths from start up to date while edits arrive on stdin:
+//    update u v w | insert u v w | delete u v | dist v
+// Each edit is answered with the number of vertices the repair touched.
+int RunDynamic(string graphFile, int start){
+   CSRGraph graph;
+   if(!graph.Load(graphFile)){
+      cerr<<"Error: Could not open file "<<graphFile<<endl;
+      return 1;
+   }
+   if(start<0 || start>=graph.GetNumVertices()){
+      cerr<<"Error: Start vertex out of range"<<endl;
+      return 1;
+   }
+   DynamicShortestPaths dynamic(graph);
+   dynamic.Compute(start);
+   string line;
+   while(getline(cin,line)){
+      istringstream fields(line);
+      string command;
+      int u=-1;
+      int v=-1;
+      int w=0;
+      if(!(fields>>command)){
+         continue;
+      }
+      fields>>u>>v>>w;
+      bool ok;
+      if(command=="update") ok=dynamic.UpdateEdge(u,v,w);
+      else if(command=="insert") ok=dynamic.InsertEdge(u,v,w);
+      else if(command=="delete") ok=dynamic.DeleteEdge(u,v);
+      else if(command=="dist" && u>=0 && u<dynamic.GetNumVertices()){
+         int d=dynamic.GetTree().distance[u];
+         cout<<u<<" ";
+         if(d==INF) cout<<"INF";
+         else cout<<d;
+         cout<<"\n";
+         continue;
+      }
+      else{
+         cerr<<"Skipping unknown command: "<<line<<endl;
+         continue;
+      }
+      if(!ok){
+         cerr<<"Rejected: "<<line<<endl;
+         continue;
+      }
+      cout<<"touched="<<dynamic.GetLastTouched()<<"\n";
+   }
+   return 0;
+}
+
+// Prints "v distance" for every vertex using Weight-typed edges, for
+// graphs whose path lengths do not fit in an int
+template<class Weight>
+int RunDistances(string graphFile, int start){
+   BasicCSRGraph<Weight> graph;
+   if(!graph.Load(graphFile)){
+      cerr<<"Error: Could not open file "<<graphFile<<endl;
+      return 1;
+   }
+   if(start<0 || start>=graph.GetNumVertices()){
+      cerr<<"Error: Start vertex out of range"<<endl;
+      return 1;
+   }
+   BasicShortestPathTree<Weight> result;
+   Dijkstra(graph,start,result);
+   cout<<setprecision(numeric_limits<Weight>::max_digits10);
+   for(int v=0;v<graph.GetNumVertices();v++){
+      cout<<v<<" ";
+      if(result.distance[v]==WeightTraits<Weight>::Infinity()) cout<<"INF";
+      else cout<<result.distance[v];
+      cout<<"\n";
+   }
+   if(result.saturated){
+      cerr<<"Warning: some path lengths overflowed and are shown as INF"<<endl;
+   }
+   return 0;
+}
+
+// A binary graph names its own weight type; a text graph uses type
+// (int32, int64, float or double)
+int RunDistances(string graphFile, int start, string type){
+   CSRFileHeader header;
+   if(CSRGraph::ReadHeader(graphFile,header)){
+      if(header.weightKind==CSR_FLOAT_WEIGHTS) type=header.weightBytes==4 ? "float" : "double";
+      else type=header.weightBytes==4 ? "int32" : "int64";
+   }
+   if(type=="int32") return RunDistances<int>(graphFile,start);
+   if(type=="int64") return RunDistances<long long>(graphFile,start);
+   if(type=="float") return RunDistances<float>(graphFile,start);
+   if(type=="double") return RunDistances<double>(graphFile,start);
+   cerr<<"Error: Unknown weight type "<<type<<endl;
+   return 1;
+}
+
+// Solves from start on several processes, each holding one vertex range,
+// and prints "v distance" for every vertex
+int RunPartitionedMode(string graphFile, int start, int processes){
+   ShortestPathTree result;
+   auto begin=chrono::steady_clock::now();
+   if(!RunPartitioned(graphFile,start,processes,result)){
+      cerr<<"Error: Partitioned run failed for "<<graphFile<<endl;
+      return 1;
+   }
+   double seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+   for(int v=0;v<(int)result.distance.size();v++){
+      cout<<v<<" ";
+      if(result.distance[v]==INF) cout<<"INF";
+      else cout<<result.distance[v];
+      cout<<"\n";
+   }
+   cerr<<"Processes: "<<processes<<", time: "<<seconds<<" s"<<endl;
+   return 0;
+}
+
+// Usage: main                                   (interactive trace)
+//        main --batch graph [queries|-] [threads] ("s t" or "s" lines)
+//        main --build-ch graph index
+//        main --ch-query index                 (s t pairs on stdin)
+//        main --dynamic graph start             (edits on stdin)
+//        main --distances graph start [int32|int64|float|double]
+//        main --partitioned graph start processes
+int main(int argc, char* argv[]) {
+   if(argc>=4 && string(argv[1])=="--build-ch"){
+      return BuildHierarchy(argv[2],argv[3]);
+   }
+   if(argc>=3 && string(argv[1])=="--ch-query"){
+      return QueryHierarchy(argv[2]);
+   }
+   if(argc>=5 && string(argv[1])=="--partitioned"){
+      return RunPartitionedMode(argv[2],atoi(argv[3]),atoi(argv[4]));
+   }
+   if(argc>=4 && string(argv[1])=="--distances"){
+      return RunDistances(argv[2],atoi(argv[3]),argc>=5 ? argv[4] : "int32");
+   }
+   if(argc>=4 && string(argv[1])=="--dynamic"){
+      return RunDynamic(argv[2],atoi(argv[3]));
+   }
+   if(argc>=3 && string(argv[1])=="--batch"){
+      string queryFile=argc>=4 ? argv[3] : "-";
+      int threads=argc>=5 ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+      return RunBatch(argv[2],queryFile,threads);
+   }
    string file;
    cout<<"Enter file name: ";
    cin>>file;
@@ -15,4 +241,4 @@ int main() {
    cin>>start;
    Graph graph;
    graph.DSP(start,file);
-}
\ No newline at end of file
+}
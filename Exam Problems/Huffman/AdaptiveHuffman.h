@@ -0,0 +1,258 @@
+#ifndef ADAPTIVEHUFFMAN_H
+#define ADAPTIVEHUFFMAN_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include "BitStream.h"
+#include "HuffmanCodec.h"
+using namespace std;
+
+// Huffman tree that follows the counts of the symbols seen so far (FGK:
+// Faller, Gallager, Knuth). Encoder and decoder start from the same empty
+// tree and update it the same way after every symbol, so no code table is
+// sent. A symbol not seen yet is sent as the code of the NYT ("not yet
+// transmitted") leaf followed by its value in plain bits, and NYT then
+// splits to make room for it.
+//
+// Nodes live at their number in the sibling order: weights never decrease
+// with the number, the two children of a node are neighbours, and the root
+// is the last node. Incrementing a leaf first swaps it with the last node
+// of its weight, which keeps the order, then does the same for its
+// parent, up to the root. Memory is the fixed node array.
+// The weights of the unused nodes below NYT are never read.
+class AdaptiveHuffmanTree{
+    private:
+        static const int NO_NODE=-1;
+        static const int INTERNAL=-1;
+        static const int NYT_SYMBOL=-2;
+    public:
+        // 256 byte values and an end of stream symbol
+        static const int END_OF_STREAM=256;
+        static const int ALPHABET_SIZE=257;
+        static const int SYMBOL_BITS=9;
+    private:
+        static const int MAX_NODES=2*(ALPHABET_SIZE+1)-1;
+        static const int ROOT=MAX_NODES-1;
+
+        uint64_t weight[MAX_NODES];
+        int parent[MAX_NODES];
+        int left[MAX_NODES];
+        int right[MAX_NODES];
+        int symbol[MAX_NODES];
+        int leafOf[ALPHABET_SIZE];
+        int nyt;
+
+        // Swaps the subtrees at nodes a and b, neither an ancestor of the
+        // other; the numbers and parents stay where they are
+        void Swap(int a, int b){
+            swap(weight[a],weight[b]);
+            swap(left[a],left[b]);
+            swap(right[a],right[b]);
+            swap(symbol[a],symbol[b]);
+            const int nodes[2]={a,b};
+            for(int node : nodes){
+                if(symbol[node]==INTERNAL){
+                    parent[left[node]]=node;
+                    parent[right[node]]=node;
+                }
+                else if(symbol[node]==NYT_SYMBOL){
+                    nyt=node;
+                }
+                else{
+                    leafOf[symbol[node]]=node;
+                }
+            }
+        }
+
+        // Adds one to the weight of node and its ancestors
+        void Increment(int node){
+            while(true){
+                int leader=node;
+                while(leader<ROOT && weight[leader+1]==weight[node]){
+                    leader++;
+                }
+                if(leader!=node && leader!=parent[node]){
+                    Swap(node,leader);
+                    node=leader;
+                }
+                weight[node]++;
+                if(node==ROOT){
+                    return;
+                }
+                node=parent[node];
+            }
+        }
+
+        // Splits NYT into a new NYT and a leaf for s; returns the leaf
+        int AddSymbol(int s){
+            int leaf=nyt-1;
+            int next=nyt-2;
+            weight[leaf]=weight[next]=0;
+            parent[leaf]=parent[next]=nyt;
+            left[leaf]=right[leaf]=left[next]=right[next]=NO_NODE;
+            symbol[leaf]=s;
+            symbol[next]=NYT_SYMBOL;
+            left[nyt]=next;
+            right[nyt]=leaf;
+            symbol[nyt]=INTERNAL;
+            leafOf[s]=leaf;
+            nyt=next;
+            return leaf;
+        }
+
+        // Writes the path from the root to node
+        void PutPath(int node, StreamBitWriter& writer) const{
+            uint8_t path[MAX_NODES];
+            int depth=0;
+            while(node!=ROOT){
+                int up=parent[node];
+                path[depth++]=right[up]==node ? 1 : 0;
+                node=up;
+            }
+            while(depth>0){
+                writer.PutBit(path[--depth]);
+            }
+        }
+
+    public:
+        AdaptiveHuffmanTree(){
+            Reset();
+        }
+
+        void Reset(){
+            for(int s=0;s<ALPHABET_SIZE;s++){
+                leafOf[s]=NO_NODE;
+            }
+            nyt=ROOT;
+            weight[ROOT]=0;
+            parent[ROOT]=left[ROOT]=right[ROOT]=NO_NODE;
+            symbol[ROOT]=NYT_SYMBOL;
+        }
+
+        void Encode(int s, StreamBitWriter& writer){
+            int leaf=leafOf[s];
+            if(leaf==NO_NODE){
+                PutPath(nyt,writer);
+                writer.Put((uint32_t)s,SYMBOL_BITS);
+                if(s==END_OF_STREAM){
+                    return;
+                }
+                leaf=AddSymbol(s);
+            }
+            else{
+                PutPath(leaf,writer);
+            }
+            Increment(leaf);
+        }
+
+        // The next symbol, or -1 if the stream ends early or is corrupt
+        int Decode(StreamBitReader& reader){
+            int node=ROOT;
+            while(symbol[node]==INTERNAL){
+                int bit=reader.GetBit();
+                if(bit<0){
+                    return -1;
+                }
+                node=bit ? right[node] : left[node];
+            }
+            if(symbol[node]!=NYT_SYMBOL){
+                int s=symbol[node];
+                Increment(node);
+                return s;
+            }
+            int s=0;
+            for(int i=0;i<SYMBOL_BITS;i++){
+                int bit=reader.GetBit();
+                if(bit<0){
+                    return -1;
+                }
+                s=(s<<1)|bit;
+            }
+            if(s>=ALPHABET_SIZE || leafOf[s]!=NO_NODE){
+                return -1;
+            }
+            if(s!=END_OF_STREAM){
+                Increment(AddSymbol(s));
+            }
+            return s;
+        }
+};
+
+// Single pass Huffman coding for pipes and sockets: no code table, no
+// length up front and no block to buffer. The stream is the codes of the
+// bytes followed by END_OF_STREAM, padded to a byte with zeros.
+class AdaptiveHuffmanCodec{
+    private:
+        AdaptiveHuffmanTree tree;
+        HuffmanStats stats;
+
+    public:
+        bool Compress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            tree.Reset();
+            StreamBitWriter writer(out);
+            char buffer[4096];
+            while(true){
+                in.read(buffer,sizeof(buffer));
+                size_t length=(size_t)in.gcount();
+                if(length==0){
+                    break;
+                }
+                for(size_t i=0;i<length;i++){
+                    tree.Encode((uint8_t)buffer[i],writer);
+                }
+                stats.inputBytes+=length;
+            }
+            tree.Encode(AdaptiveHuffmanTree::END_OF_STREAM,writer);
+            writer.Flush();
+            stats.outputBytes=writer.GetBytesWritten();
+            stats.blocks=stats.inputBytes>0 ? 1 : 0;
+            return !in.bad() && (bool)out;
+        }
+
+        bool Decompress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            tree.Reset();
+            StreamBitReader reader(in);
+            char buffer[4096];
+            size_t length=0;
+            bool ok=true;
+            while(true){
+                int s=tree.Decode(reader);
+                if(s<0 || s==AdaptiveHuffmanTree::END_OF_STREAM){
+                    ok=s==AdaptiveHuffmanTree::END_OF_STREAM;
+                    break;
+                }
+                buffer[length++]=(char)s;
+                if(length==sizeof(buffer)){
+                    out.write(buffer,length);
+                    stats.outputBytes+=length;
+                    length=0;
+                }
+            }
+            out.write(buffer,length);
+            stats.outputBytes+=length;
+            stats.inputBytes=reader.GetBytesRead();
+            stats.blocks=stats.outputBytes>0 ? 1 : 0;
+            return ok && (bool)out;
+        }
+
+        bool CompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Compress(in,out);
+        }
+        bool DecompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Decompress(in,out);
+        }
+
+        const HuffmanStats& GetStats() const{
+            return stats;
+        }
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include "HuffmanTree.h"
+#include "Histogram.h"
+#include "LengthLimited.h"
+#include "HuffmanCodec.h"
+#include "AdaptiveHuffman.h"
+#include "LzHuffman.h"
+using namespace std;
+
+// What one coder did with one file
+struct VariantResult{
+    string name;
+    long long compressedBytes=0;
+    long long headerBytes=0;
+    double encodeSeconds=0;
+    double decodeSeconds=0;
+    bool roundTrip=false;
+};
+
+struct FileResult{
+    string name;
+    long long bytes=0;
+    int distinctSymbols=0;
+    double entropy=0;
+    double expectedLength=0;
+    double expectedLimitedLength=0;
+    long long canonicalTableBytes=0;
+    long long explicitTableBytes=0;
+    vector<VariantResult> variants;
+};
+
+const int LIMITED_LENGTH=11;
+
+double Seconds(chrono::steady_clock::time_point begin){
+    return chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+}
+
+// Shannon entropy of the byte distribution in bits per byte: the least
+// any code of single bytes can average
+double Entropy(const uint64_t counts[256], uint64_t total){
+    double bits=0;
+    for(int s=0;s<256;s++){
+        if(counts[s]>0){
+            double p=(double)counts[s]/total;
+            bits-=p*log2(p);
+        }
+    }
+    return bits;
+}
+
+// Round trip through codec in memory. Small files are repeated until
+// a tenth of a second has passed, and the fastest run counts.
+template<class Codec>
+VariantResult Measure(const string& name, Codec& codec, const vector<uint8_t>& data){
+    VariantResult result;
+    result.name=name;
+    string raw(data.begin(),data.end());
+    string packed;
+    string unpacked;
+    result.encodeSeconds=result.decodeSeconds=1e30;
+    bool ok=true;
+    auto start=chrono::steady_clock::now();
+    do{
+        istringstream in(raw);
+        ostringstream out;
+        auto begin=chrono::steady_clock::now();
+        ok=codec.Compress(in,out) && ok;
+        result.encodeSeconds=min(result.encodeSeconds,Seconds(begin));
+        result.headerBytes=codec.GetStats().headerBytes;
+        packed=out.str();
+
+        istringstream packedIn(packed);
+        ostringstream packedOut;
+        begin=chrono::steady_clock::now();
+        ok=codec.Decompress(packedIn,packedOut) && ok;
+        result.decodeSeconds=min(result.decodeSeconds,Seconds(begin));
+        unpacked=packedOut.str();
+    } while(Seconds(start)<0.1);
+    result.compressedBytes=(long long)packed.size();
+    result.roundTrip=ok && unpacked==raw;
+    return result;
+}
+
+FileResult Analyze(const string& name, const vector<uint8_t>& data){
+    FileResult result;
+    result.name=name;
+    result.bytes=(long long)data.size();
+    uint64_t counts[256]={0};
+    CountBytes(data.data(),data.size(),counts);
+    if(!data.empty()){
+        // One code for the whole file, as the demo message gets
+        HuffmanCode codes[256];
+        HuffmanTree tree(counts);
+        tree.HuffmanGetCodes(codes);
+        int lengths[256];
+        int limited[256];
+        for(int s=0;s<256;s++){
+            lengths[s]=codes[s].length;
+        }
+        PackageMergeLengths(counts,limited,LIMITED_LENGTH);
+        result.entropy=Entropy(counts,data.size());
+        result.expectedLength=(double)EncodedBits(counts,lengths)/data.size();
+        result.expectedLimitedLength=(double)EncodedBits(counts,limited)/data.size();
+        // A canonical table is a length per symbol; an explicit one also
+        // spells out each code
+        for(int s=0;s<256;s++){
+            if(counts[s]>0){
+                result.distinctSymbols++;
+                result.canonicalTableBytes+=2;
+                result.explicitTableBytes+=2+(lengths[s]+7)/8;
+            }
+        }
+    }
+
+    HuffmanCodec single(HuffmanCodec::DEFAULT_BLOCK_SIZE,MAX_CODE_LENGTH,1);
+    result.variants.push_back(Measure("static",single,data));
+    HuffmanCodec streams(HuffmanCodec::DEFAULT_BLOCK_SIZE,MAX_CODE_LENGTH,HuffmanCodec::DEFAULT_STREAMS);
+    result.variants.push_back(Measure("static, "+to_string(HuffmanCodec::DEFAULT_STREAMS)+" streams",streams,data));
+    HuffmanCodec limitedCodec(HuffmanCodec::DEFAULT_BLOCK_SIZE,LIMITED_LENGTH,1);
+    result.variants.push_back(Measure("length-limited "+to_string(LIMITED_LENGTH),limitedCodec,data));
+    AdaptiveHuffmanCodec adaptive;
+    result.variants.push_back(Measure("adaptive",adaptive,data));
+    LzHuffmanCodec lz;
+    result.variants.push_back(Measure("lz77+huffman",lz,data));
+    return result;
+}
+
+string JsonString(const string& text){
+    string result="\"";
+    for(unsigned char c : text){
+        if(c=='"' || c=='\\'){
+            result+='\\';
+            result+=(char)c;
+        }
+        else if(c<0x20){
+            char escape[8];
+            snprintf(escape,sizeof(escape),"\\u%04x",c);
+            result+=escape;
+        }
+        else{
+            result+=(char)c;
+        }
+    }
+    return result+"\"";
+}
+
+// Throughput in MB/s, 0 when there was nothing to time
+double Speed(long long bytes, double seconds){
+    return seconds>0 && bytes>0 ? bytes/1e6/seconds : 0;
+}
+
+void PrintJson(const vector<FileResult>& files){
+    cout.precision(6);
+    cout << "{\n  \"files\": [";
+    for(size_t f=0;f<files.size();f++){
+        const FileResult& file=files[f];
+        cout << (f>0 ? "," : "") << "\n    {\n"
+             << "      \"name\": " << JsonString(file.name) << ",\n"
+             << "      \"bytes\": " << file.bytes << ",\n"
+             << "      \"distinct_symbols\": " << file.distinctSymbols << ",\n"
+             << "      \"entropy_bits_per_byte\": " << file.entropy << ",\n"
+             << "      \"expected_code_length\": " << file.expectedLength << ",\n"
+             << "      \"expected_code_length_limit_" << LIMITED_LENGTH << "\": " << file.expectedLimitedLength << ",\n"
+             << "      \"code_table_bytes\": {\"canonical\": " << file.canonicalTableBytes
+             << ", \"explicit\": " << file.explicitTableBytes << "},\n"
+             << "      \"variants\": [";
+        for(size_t v=0;v<file.variants.size();v++){
+            const VariantResult& variant=file.variants[v];
+            cout << (v>0 ? "," : "") << "\n        {"
+                 << "\"name\": " << JsonString(variant.name)
+                 << ", \"compressed_bytes\": " << variant.compressedBytes
+                 << ", \"header_bytes\": " << variant.headerBytes
+                 << ", \"ratio\": " << (file.bytes>0 ? (double)variant.compressedBytes/file.bytes : 0)
+                 << ", \"bits_per_byte\": " << (file.bytes>0 ? 8.0*variant.compressedBytes/file.bytes : 0)
+                 << ", \"encode_mb_per_s\": " << Speed(file.bytes,variant.encodeSeconds)
+                 << ", \"decode_mb_per_s\": " << Speed(file.bytes,variant.decodeSeconds)
+                 << ", \"round_trip\": " << (variant.roundTrip ? "true" : "false") << "}";
+        }
+        cout << "\n      ]\n    }";
+    }
+    // Sums over the corpus, per variant
+    cout << "\n  ],\n  \"totals\": [";
+    long long bytes=0;
+    for(const FileResult& file : files){
+        bytes+=file.bytes;
+    }
+    size_t numVariants=files.empty() ? 0 : files[0].variants.size();
+    for(size_t v=0;v<numVariants;v++){
+        long long compressed=0;
+        double encodeSeconds=0;
+        double decodeSeconds=0;
+        bool ok=true;
+        for(const FileResult& file : files){
+            compressed+=file.variants[v].compressedBytes;
+            encodeSeconds+=file.variants[v].encodeSeconds;
+            decodeSeconds+=file.variants[v].decodeSeconds;
+            ok=ok && file.variants[v].roundTrip;
+        }
+        cout << (v>0 ? "," : "") << "\n    {"
+             << "\"name\": " << JsonString(files[0].variants[v].name)
+             << ", \"bytes\": " << bytes
+             << ", \"compressed_bytes\": " << compressed
+             << ", \"ratio\": " << (bytes>0 ? (double)compressed/bytes : 0)
+             << ", \"encode_mb_per_s\": " << Speed(bytes,encodeSeconds)
+             << ", \"decode_mb_per_s\": " << Speed(bytes,decodeSeconds)
+             << ", \"round_trip\": " << (ok ? "true" : "false") << "}";
+    }
+    cout << "\n  ]\n}" << endl;
+}
+
+// Usage: Analysis [file or directory]...
+// Prints JSON on stdout: per file the entropy, the expected length of one
+// Huffman code for the whole file, and every coder's size, overhead and
+// speed; then the corpus totals. Directories are walked recursively.
+// With no arguments it analyzes the demo message of Huffman.cpp, whose
+// expected length ExpectedLength.txt works out by hand.
+int main(int argc, char* argv[]){
+    vector<FileResult> results;
+    if(argc<2){
+        string message="abbcccddddeeeeeffffffgggggggghhhhhhhhhhh";
+        results.push_back(Analyze("demo message",vector<uint8_t>(message.begin(),message.end())));
+    }
+    vector<string> paths;
+    for(int i=1;i<argc;i++){
+        error_code error;
+        if(filesystem::is_directory(argv[i],error)){
+            for(const auto& entry : filesystem::recursive_directory_iterator(argv[i],error)){
+                if(entry.is_regular_file()){
+                    paths.push_back(entry.path().string());
+                }
+            }
+        }
+        else{
+            paths.push_back(argv[i]);
+        }
+    }
+    sort(paths.begin(),paths.end());
+    for(const string& path : paths){
+        ifstream input(path, ios::binary);
+        if(!input.is_open()){
+            cerr<<"Error: Could not open file "<<path<<endl;
+            return 1;
+        }
+        vector<uint8_t> data((istreambuf_iterator<char>(input)),istreambuf_iterator<char>());
+        results.push_back(Analyze(path,data));
+    }
+    PrintJson(results);
+    return 0;
+}
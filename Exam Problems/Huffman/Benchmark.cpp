@@ -0,0 +1,355 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include "HuffmanTree.h"
+#include "Histogram.h"
+#include "LengthLimited.h"
+#include "HuffmanCodec.h"
+#include "AdaptiveHuffman.h"
+#include "SymbolHuffman.h"
+#include "LzHuffman.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+using namespace std;
+
+// The frequency table as it was: a pointer per byte value, a heap-allocated
+// Character with its own code string the first time a byte appears, and a
+// temporary Character built by value for every input byte
+struct LegacyCharacter{
+    char character;
+    int frequency=1;
+    string code="";
+    LegacyCharacter* parent;
+    LegacyCharacter* left;
+    LegacyCharacter* right;
+
+    LegacyCharacter(char c){
+        character=c;
+        parent=left=right=nullptr;
+    }
+};
+
+class LegacyTable{
+    private:
+        LegacyCharacter* table[256];
+    public:
+        LegacyTable(){
+            for(int i=0;i<256;i++){
+                table[i]=nullptr;
+            }
+        }
+        ~LegacyTable(){
+            for(int i=0;i<256;i++){
+                delete table[i];
+            }
+        }
+        void Insert(LegacyCharacter c){
+            int key=(unsigned char)c.character;
+            if(table[key]==nullptr){
+                table[key]=new LegacyCharacter(c);
+            }
+            else{
+                table[key]->frequency++;
+            }
+        }
+        void BuildTable(const uint8_t* data, size_t length){
+            for(size_t i=0;i<length;i++){
+                LegacyCharacter c((char)data[i]);
+                Insert(c);
+            }
+        }
+        uint64_t GetCount(int index) const{
+            return table[index]==nullptr ? 0 : table[index]->frequency;
+        }
+};
+
+// One counter per byte value: every byte of a run waits on the last store
+void CountBytesSingle(const uint8_t* data, size_t length, uint64_t counts[256]){
+    for(size_t i=0;i<length;i++){
+        counts[data[i]]++;
+    }
+}
+
+uint64_t Cycles(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+double Seconds(chrono::steady_clock::time_point begin){
+    return chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+}
+
+// Text-like bytes: a few dozen symbols with a skewed distribution
+vector<uint8_t> TextData(size_t n, unsigned seed){
+    mt19937 rng(seed);
+    const string alphabet="etaoinshrdlucmfwypvbgkjqxz  ,.\n0123456789ETAOINS";
+    geometric_distribution<int> pick(0.12);
+    vector<uint8_t> data(n);
+    for(size_t i=0;i<n;i++){
+        data[i]=(uint8_t)alphabet[pick(rng)%alphabet.size()];
+    }
+    return data;
+}
+
+// Long runs of one byte: the worst case for a single histogram
+vector<uint8_t> RunData(size_t n, unsigned seed){
+    mt19937 rng(seed);
+    uniform_int_distribution<int> runLength(64,4096);
+    uniform_int_distribution<int> byteDist(0,255);
+    vector<uint8_t> data(n);
+    size_t i=0;
+    while(i<n){
+        uint8_t b=(uint8_t)byteDist(rng);
+        size_t end=min(n,i+(size_t)runLength(rng));
+        for(;i<end;i++){
+            data[i]=b;
+        }
+    }
+    return data;
+}
+
+// Each symbol half as likely as the one before: unconstrained codes grow
+// as long as the alphabet is wide
+vector<uint8_t> SkewedData(size_t n, unsigned seed){
+    mt19937 rng(seed);
+    geometric_distribution<int> pick(0.5);
+    vector<uint8_t> data(n);
+    for(size_t i=0;i<n;i++){
+        data[i]=(uint8_t)(pick(rng)%64);
+    }
+    return data;
+}
+
+vector<uint8_t> RandomData(size_t n, unsigned seed){
+    mt19937 rng(seed);
+    vector<uint8_t> data(n);
+    for(size_t i=0;i<n;i++){
+        data[i]=(uint8_t)rng();
+    }
+    return data;
+}
+
+template<class Count>
+void RunHistogram(const string& name, const vector<uint8_t>& data, const uint64_t expected[256], Count count){
+    uint64_t counts[256]={0};
+    auto begin=chrono::steady_clock::now();
+    uint64_t startCycles=Cycles();
+    count(data.data(),data.size(),counts);
+    uint64_t cycles=Cycles()-startCycles;
+    double seconds=Seconds(begin);
+    bool match=true;
+    for(int s=0;s<256;s++){
+        match=match && counts[s]==expected[s];
+    }
+    cout << "  " << left << setw(22) << name << right << fixed << setprecision(1)
+         << setw(9) << data.size()/1e6/seconds << " MB/s";
+    if(cycles>0){
+        cout << setprecision(2) << setw(8) << (double)data.size()/cycles << " bytes/cycle";
+    }
+    cout << (match ? "" : "  MISMATCH") << endl;
+}
+
+void RunHistograms(const string& title, const vector<uint8_t>& data){
+    cout << title << " (" << data.size()/1000000 << " MB)" << endl;
+    uint64_t expected[256]={0};
+    CountBytesSingle(data.data(),data.size(),expected);
+    RunHistogram("legacy Table",data,expected,[](const uint8_t* d, size_t n, uint64_t counts[256]){
+        LegacyTable table;
+        table.BuildTable(d,n);
+        for(int s=0;s<256;s++){
+            counts[s]=table.GetCount(s);
+        }
+    });
+    RunHistogram("flat, one histogram",data,expected,CountBytesSingle);
+    RunHistogram("flat, 4 interleaved",data,expected,CountBytes);
+}
+
+// Encodes data in blocks with codes of at most maxLength bits, checks the
+// round trip and returns the decode throughput in MB/s
+double DecodeSpeed(const vector<uint8_t>& data, int maxLength, int streams=1){
+    size_t blockSize=HuffmanCodec::DEFAULT_BLOCK_SIZE;
+    vector<vector<uint8_t>> blocks;
+    for(size_t at=0;at<data.size();at+=blockSize){
+        blocks.emplace_back();
+        HuffmanCodec::EncodeBlock(data.data()+at,min(blockSize,data.size()-at),blocks.back(),maxLength,streams);
+    }
+    vector<uint8_t> out(data.size());
+    auto begin=chrono::steady_clock::now();
+    bool ok=true;
+    for(size_t b=0;b<blocks.size();b++){
+        size_t at=b*blockSize;
+        ok=HuffmanCodec::DecodeBlock(blocks[b].data(),blocks[b].size(),out.data()+at,min(blockSize,data.size()-at),streams) && ok;
+    }
+    double seconds=Seconds(begin);
+    return ok && out==data ? data.size()/1e6/seconds : -1;
+}
+
+// Ratio lost to a code length limit, against unconstrained Huffman over
+// the whole data, for package-merge and for the count-halving heuristic
+void RunLengthLimits(const string& title, const vector<uint8_t>& data){
+    cout << title << " (" << data.size()/1000000 << " MB), length-limited codes" << endl;
+    uint64_t counts[256]={0};
+    CountBytes(data.data(),data.size(),counts);
+    int lengths[256];
+    HuffmanCodeLengths(counts,lengths,256);
+    uint64_t optimal=EncodedBits(counts,lengths);
+    int longest=*max_element(lengths,lengths+256);
+    cout << "  unconstrained: longest code " << longest << ", " << fixed << setprecision(4)
+         << (double)optimal/data.size() << " bits/byte, decode "
+         << setprecision(0) << DecodeSpeed(data,MAX_CODE_LENGTH) << " MB/s" << endl;
+    const int limits[]={8,9,10,11,12,15};
+    for(int limit : limits){
+        int merged[256];
+        int halved[256];
+        PackageMergeLengths(counts,merged,limit);
+        HuffmanCodeLengths(counts,halved,limit);
+        double loss=100.0*((double)EncodedBits(counts,merged)/optimal-1);
+        double heuristicLoss=100.0*((double)EncodedBits(counts,halved)/optimal-1);
+        cout << "  limit " << setw(2) << limit << ": package-merge +" << setprecision(3) << loss
+             << "%, halving +" << heuristicLoss << "%, decode " << setprecision(0)
+             << DecodeSpeed(data,limit) << " MB/s" << endl;
+    }
+}
+
+// Decode throughput of one block stream against 2, 4 and 8 decoded in
+// lockstep, unconstrained and with codes that fit the first table
+void RunStreams(const string& title, const vector<uint8_t>& data){
+    cout << title << " (" << data.size()/1000000 << " MB), interleaved streams" << endl;
+    const int limits[]={MAX_CODE_LENGTH,11};
+    for(int limit : limits){
+        cout << "  " << (limit==MAX_CODE_LENGTH ? "unconstrained:" : "limit 11:     ") << fixed << setprecision(0);
+        double single=0;
+        for(int streams=1;streams<=HuffmanCodec::MAX_STREAMS;streams*=2){
+            double speed=DecodeSpeed(data,limit,streams);
+            single=streams==1 ? speed : single;
+            cout << setw(6) << speed << " MB/s x" << streams;
+            if(streams>1){
+                cout << " (" << setprecision(2) << speed/single << setprecision(0) << "x)";
+            }
+        }
+        cout << endl;
+    }
+}
+
+// Compresses and decompresses data in memory, checks the round trip and
+// prints the ratio and both throughputs
+template<class Codec>
+void RunCodec(const string& name, Codec& codec, const vector<uint8_t>& data){
+    istringstream raw(string(data.begin(),data.end()));
+    ostringstream packed;
+    auto begin=chrono::steady_clock::now();
+    bool ok=codec.Compress(raw,packed);
+    double encodeSeconds=Seconds(begin);
+    istringstream packedIn(packed.str());
+    ostringstream unpacked;
+    begin=chrono::steady_clock::now();
+    ok=codec.Decompress(packedIn,unpacked) && ok;
+    double decodeSeconds=Seconds(begin);
+    ok=ok && unpacked.str()==string(data.begin(),data.end());
+    cout << "  " << left << setw(22) << name << right << fixed << setprecision(2)
+         << setw(7) << 100.0*packed.str().size()/data.size() << "%"
+         << setprecision(1) << setw(9) << data.size()/1e6/encodeSeconds << " MB/s encode"
+         << setw(9) << data.size()/1e6/decodeSeconds << " MB/s decode"
+         << (ok ? "" : "  MISMATCH") << endl;
+}
+
+// The one-pass adaptive coder against the two-pass block coder on the
+// same bytes. The adaptive coder works a bit at a time, so it gets at most
+// 16 MB.
+void RunAdaptive(const string& title, const vector<uint8_t>& data){
+    vector<uint8_t> sample(data.begin(),data.begin()+min(data.size(),(size_t)16000000));
+    cout << title << " (" << sample.size()/1000000 << " MB), static against adaptive" << endl;
+    HuffmanCodec blocks;
+    RunCodec("static, 1 MiB blocks",blocks,sample);
+    AdaptiveHuffmanCodec adaptive;
+    RunCodec("adaptive (FGK)",adaptive,sample);
+}
+
+// Codes the data as Symbols read from it in native byte order, in 1 MiB
+// blocks, and prints the ratio and throughputs like RunCodec
+template<class Symbol, uint64_t ALPHABET_SIZE>
+void RunSymbolBlocks(const string& name, const vector<uint8_t>& data){
+    const size_t perBlock=((size_t)1<<20)/sizeof(Symbol);
+    size_t count=data.size()/sizeof(Symbol);
+    vector<Symbol> symbols(count);
+    memcpy(symbols.data(),data.data(),count*sizeof(Symbol));
+    vector<vector<uint8_t>> blocks;
+    auto begin=chrono::steady_clock::now();
+    for(size_t at=0;at<count;at+=perBlock){
+        blocks.emplace_back();
+        SymbolHuffmanCodec<Symbol,ALPHABET_SIZE>::EncodeBlock(symbols.data()+at,min(perBlock,count-at),blocks.back());
+    }
+    double encodeSeconds=Seconds(begin);
+    vector<Symbol> decoded(count);
+    bool ok=true;
+    size_t packed=0;
+    begin=chrono::steady_clock::now();
+    for(size_t b=0;b<blocks.size();b++){
+        size_t at=b*perBlock;
+        ok=SymbolHuffmanCodec<Symbol,ALPHABET_SIZE>::DecodeBlock(blocks[b].data(),blocks[b].size(),decoded.data()+at,min(perBlock,count-at)) && ok;
+        packed+=blocks[b].size();
+    }
+    double decodeSeconds=Seconds(begin);
+    ok=ok && decoded==symbols;
+    size_t bytes=count*sizeof(Symbol);
+    cout << "  " << left << setw(22) << name << right << fixed << setprecision(2)
+         << setw(7) << 100.0*packed/bytes << "%"
+         << setprecision(1) << setw(9) << bytes/1e6/encodeSeconds << " MB/s encode"
+         << setw(9) << bytes/1e6/decodeSeconds << " MB/s decode"
+         << (ok ? "" : "  MISMATCH") << endl;
+}
+
+// The same bytes as 8, 16 and 32-bit symbols, the last through the hash
+// table, and as LZ77 tokens
+void RunAlphabets(const string& title, const vector<uint8_t>& data){
+    vector<uint8_t> sample(data.begin(),data.begin()+min(data.size(),(size_t)16000000));
+    cout << title << " (" << sample.size()/1000000 << " MB), symbol alphabets" << endl;
+    HuffmanCodec bytes;
+    RunCodec("bytes",bytes,sample);
+    RunSymbolBlocks<uint16_t,(uint64_t)1<<16>("16-bit symbols",sample);
+    RunSymbolBlocks<uint32_t,(uint64_t)1<<32>("32-bit, hash table",sample);
+    LzHuffmanCodec lz;
+    RunCodec("LZ77 + Huffman",lz,sample);
+}
+
+// Usage: Benchmark [megabytes] [file]
+int main(int argc, char* argv[]){
+    size_t n=(argc>1 ? atoi(argv[1]) : 64)*(size_t)1000000;
+    if(argc>2){
+        ifstream input(argv[2], ios::binary);
+        if(!input.is_open()){
+            cerr<<"Error: Could not open file "<<argv[2]<<endl;
+            return 1;
+        }
+        vector<uint8_t> data((istreambuf_iterator<char>(input)),istreambuf_iterator<char>());
+        RunHistograms(argv[2],data);
+        RunLengthLimits(argv[2],data);
+        RunStreams(argv[2],data);
+        RunAdaptive(argv[2],data);
+        RunAlphabets(argv[2],data);
+        return 0;
+    }
+    RunHistograms("Text",TextData(n,1));
+    RunHistograms("Runs of one byte",RunData(n,2));
+    RunHistograms("Random bytes",RandomData(n,3));
+    RunLengthLimits("Text",TextData(n,1));
+    RunLengthLimits("Skewed",SkewedData(n,4));
+    RunStreams("Text",TextData(n,1));
+    RunStreams("Skewed",SkewedData(n,4));
+    RunAdaptive("Text",TextData(n,1));
+    RunAdaptive("Skewed",SkewedData(n,4));
+    RunAdaptive("Random bytes",RandomData(n,3));
+    RunAlphabets("Text",TextData(n,1));
+    RunAlphabets("Runs of one byte",RunData(n,2));
+    return 0;
+}
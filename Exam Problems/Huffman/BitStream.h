@@ -0,0 +1,212 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+using namespace std;
+
+// Bits are packed most significant first, so a code's first bit is the
+// high bit of its first byte and a byte-aligned prefix of the stream reads
+// the same in any order of bytes.
+
+inline uint64_t LoadBigEndian64(const uint8_t* p){
+    uint64_t word;
+    memcpy(&word,p,8);
+#if defined(__GNUC__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+    return __builtin_bswap64(word);
+#elif defined(__GNUC__)
+    return word;
+#else
+    return ((uint64_t)p[0]<<56)|((uint64_t)p[1]<<48)|((uint64_t)p[2]<<40)|((uint64_t)p[3]<<32)|
+           ((uint64_t)p[4]<<24)|((uint64_t)p[5]<<16)|((uint64_t)p[6]<<8)|(uint64_t)p[7];
+#endif
+}
+
+// Writes into a buffer the caller has sized already; Huffman blocks know
+// their exact payload size before encoding. Up to 63 bits wait in a 64-bit
+// accumulator and leave 32 at a time.
+class BitWriter{
+    private:
+        uint8_t* out;
+        size_t pos=0;
+        uint64_t buffer=0;
+        int count=0;
+    public:
+        BitWriter(uint8_t* dest) : out(dest){}
+
+        // length is at most 32
+        void Put(uint32_t bits, int length){
+            buffer=(buffer<<length)|bits;
+            count+=length;
+            if(count>=32){
+                count-=32;
+                uint32_t word=(uint32_t)(buffer>>count);
+                out[pos]=(uint8_t)(word>>24);
+                out[pos+1]=(uint8_t)(word>>16);
+                out[pos+2]=(uint8_t)(word>>8);
+                out[pos+3]=(uint8_t)word;
+                pos+=4;
+            }
+        }
+        // Pads the last byte with zeros; returns the bytes written
+        size_t Flush(){
+            int pad=(8-count%8)%8;
+            buffer<<=pad;
+            count+=pad;
+            while(count>0){
+                count-=8;
+                out[pos++]=(uint8_t)(buffer>>count);
+            }
+            return pos;
+        }
+};
+
+// Keeps the next bits left-aligned in a 64-bit buffer. After Refill at
+// least 56 bits are buffered, so any code up to that length can be peeked
+// without checking. Past the end of the data it reads zeros and remembers
+// it, so a corrupt stream cannot read out of bounds.
+class BitReader{
+    private:
+        const uint8_t* data;
+        const uint8_t* end;
+        uint64_t buffer=0;
+        int count=0;
+        long long padding=0;
+    public:
+        BitReader(const uint8_t* begin, size_t length) : data(begin), end(begin+length){}
+        // An empty reader, to be assigned; lets decoders keep arrays of them
+        BitReader() : data(nullptr), end(nullptr){}
+
+        void Refill(){
+            if(end-data>=8){
+                // Loads whole words; bytes only partly taken are loaded
+                // again next time, at the same position, so OR is harmless
+                buffer|=LoadBigEndian64(data)>>count;
+                data+=(63-count)>>3;
+                count|=56;
+                return;
+            }
+            while(count<=56){
+                uint64_t byte=0;
+                if(data<end){
+                    byte=*data++;
+                }
+                else{
+                    padding++;
+                }
+                buffer|=byte<<(56-count);
+                count+=8;
+            }
+        }
+        // Refill for callers that checked Remaining() is at least 8
+        void RefillFast(){
+            buffer|=LoadBigEndian64(data)>>count;
+            data+=(63-count)>>3;
+            count|=56;
+        }
+        // Bytes not loaded yet
+        size_t Remaining() const{
+            return (size_t)(end-data);
+        }
+        // 1 <= n <= 56, after Refill
+        uint32_t Peek(int n) const{
+            return (uint32_t)(buffer>>(64-n));
+        }
+        void Skip(int n){
+            buffer<<=n;
+            count-=n;
+        }
+        // Bits buffered; Refill brings it to at least 56
+        int Available() const{
+            return count;
+        }
+        // True once more bits were consumed than the data holds
+        bool Overrun() const{
+            return padding*8>count;
+        }
+};
+
+// One bit at a time to an ostream through a small buffer, for coders
+// whose model changes after every symbol. Same bit order as BitWriter.
+class StreamBitWriter{
+    private:
+        ostream& out;
+        uint8_t buffer[4096];
+        size_t pos=0;
+        unsigned current=0;
+        int used=0;
+        long long written=0;
+    public:
+        StreamBitWriter(ostream& stream) : out(stream){}
+
+        void PutBit(int bit){
+            current=(current<<1)|bit;
+            if(++used==8){
+                buffer[pos++]=(uint8_t)current;
+                current=0;
+                used=0;
+                if(pos==sizeof(buffer)){
+                    out.write((const char*)buffer,pos);
+                    written+=pos;
+                    pos=0;
+                }
+            }
+        }
+        void Put(uint32_t bits, int length){
+            for(int i=length-1;i>=0;i--){
+                PutBit((bits>>i)&1);
+            }
+        }
+        // Pads the last byte with zeros and writes everything out
+        void Flush(){
+            while(used!=0){
+                PutBit(0);
+            }
+            out.write((const char*)buffer,pos);
+            written+=pos;
+            pos=0;
+        }
+        long long GetBytesWritten() const{
+            return written;
+        }
+};
+
+// One bit at a time from an istream through a small buffer
+class StreamBitReader{
+    private:
+        istream& in;
+        uint8_t buffer[4096];
+        size_t pos=0;
+        size_t length=0;
+        unsigned current=0;
+        int left=0;
+        long long read=0;
+    public:
+        StreamBitReader(istream& stream) : in(stream){}
+
+        // The next bit, or -1 at the end of the stream
+        int GetBit(){
+            if(left==0){
+                if(pos==length){
+                    in.read((char*)buffer,sizeof(buffer));
+                    length=(size_t)in.gcount();
+                    pos=0;
+                    read+=length;
+                    if(length==0){
+                        return -1;
+                    }
+                }
+                current=buffer[pos++];
+                left=8;
+            }
+            left--;
+            return (current>>left)&1;
+        }
+        long long GetBytesRead() const{
+            return read;
+        }
+};
+
+#endif
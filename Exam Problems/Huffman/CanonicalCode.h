@@ -0,0 +1,286 @@
+#ifndef CANONICALCODE_H
+#define CANONICALCODE_H
+
+#include <vector>
+#include <cstdint>
+#include "HuffmanTree.h"
+#include "BitStream.h"
+using namespace std;
+
+const int MAX_CODE_LENGTH=32;
+
+// Canonical Huffman code: symbols sorted by (length, symbol) get
+// consecutive codes, stepping to the next length by appending zeros. The
+// code is then fixed by the lengths alone, which is all a header needs
+// to store, and the codes of one length form a contiguous range.
+// Returns false if the lengths cannot be a prefix code (Kraft sum above
+// 1). Symbols of length 0 do not occur and get no code.
+inline bool AssignCanonicalCodes(const int lengths[], int alphabetSize, HuffmanCode codes[]){
+    int count[MAX_CODE_LENGTH+1]={0};
+    for(int s=0;s<alphabetSize;s++){
+        if(lengths[s]<0 || lengths[s]>MAX_CODE_LENGTH){
+            return false;
+        }
+        count[lengths[s]]++;
+    }
+    count[0]=0;
+    uint64_t next[MAX_CODE_LENGTH+1]={0};
+    uint64_t code=0;
+    for(int length=1;length<=MAX_CODE_LENGTH;length++){
+        code=(code+count[length-1])<<1;
+        next[length]=code;
+        if(code+count[length]>((uint64_t)1<<length)){
+            return false;
+        }
+    }
+    for(int s=0;s<alphabetSize;s++){
+        int length=lengths[s];
+        codes[s]={length>0 ? (uint32_t)next[length]++ : 0,length};
+    }
+    return true;
+}
+
+// Table-driven canonical decoder. One lookup on the next TABLE_BITS bits
+// gives every symbol whose code lies wholly inside them, up to two, and
+// the bits they take; the entries for a code's suffixes repeat it. With
+// the usual 4-6 bit codes of text that halves the chain of dependent
+// lookups a bitstream imposes. The rare codes longer than TABLE_BITS fall
+// through to a secondary table indexed by length: the first code of each
+// length and where its symbols start in symbol order, checked one length
+// at a time. Symbols must fit in a byte.
+class HuffmanDecoder{
+    private:
+        // 2^11 four-byte entries: 8 KiB, comfortably inside L1
+        static const int TABLE_BITS=11;
+        // first symbol | second<<8 | first's length<<16 | both lengths<<20
+        // | symbols<<24. 0 symbols sends the lookup to the long path.
+        vector<uint32_t> table;
+        int maxLength=0;
+        uint32_t firstCode[MAX_CODE_LENGTH+1];
+        int count[MAX_CODE_LENGTH+1];
+        int offset[MAX_CODE_LENGTH+1];
+        vector<int> sorted;
+
+        int DecodeLong(BitReader& reader) const{
+            for(int length=TABLE_BITS+1;length<=maxLength;length++){
+                uint32_t code=reader.Peek(length);
+                if(code-firstCode[length]<(uint32_t)count[length]){
+                    reader.Skip(length);
+                    return sorted[offset[length]+(code-firstCode[length])];
+                }
+            }
+            return -1;
+        }
+
+        // One lookup: one or two symbols to out[i..], or the long path
+        template<class Symbol>
+        bool DecodeStep(BitReader& local, const uint32_t* lookup, Symbol* out, size_t& i) const{
+            uint32_t entry=lookup[local.Peek(TABLE_BITS)];
+            if(entry>>24){
+                out[i]=(Symbol)(entry&0xFF);
+                out[i+1]=(Symbol)((entry>>8)&0xFF);
+                i+=entry>>24;
+                local.Skip((entry>>20)&0xF);
+                return true;
+            }
+            int symbol=DecodeLong(local);
+            if(symbol<0){
+                return false;
+            }
+            out[i++]=(Symbol)symbol;
+            return true;
+        }
+
+    public:
+        // False if the lengths do not form a prefix code
+        bool Build(const int lengths[], int alphabetSize){
+            vector<HuffmanCode> codes(alphabetSize);
+            if(alphabetSize>256 || !AssignCanonicalCodes(lengths,alphabetSize,codes.data())){
+                return false;
+            }
+            int size=1<<TABLE_BITS;
+            vector<uint32_t> single(size,0);
+            maxLength=0;
+            for(int length=0;length<=MAX_CODE_LENGTH;length++){
+                count[length]=0;
+                firstCode[length]=0;
+            }
+            for(int s=0;s<alphabetSize;s++){
+                count[lengths[s]]++;
+                maxLength=lengths[s]>maxLength ? lengths[s] : maxLength;
+            }
+            count[0]=0;
+            int at=0;
+            for(int length=1;length<=MAX_CODE_LENGTH;length++){
+                offset[length]=at;
+                at+=count[length];
+            }
+            sorted.assign(at,0);
+            vector<int> fill(offset,offset+MAX_CODE_LENGTH+1);
+            // Symbols in order, so each length's first is its lowest code
+            for(int s=0;s<alphabetSize;s++){
+                int length=lengths[s];
+                if(length==0){
+                    continue;
+                }
+                if(fill[length]==offset[length]){
+                    firstCode[length]=codes[s].bits;
+                }
+                sorted[fill[length]++]=s;
+                if(length<=TABLE_BITS){
+                    uint32_t first=codes[s].bits<<(TABLE_BITS-length);
+                    uint32_t last=(codes[s].bits+1)<<(TABLE_BITS-length);
+                    for(uint32_t i=first;i<last;i++){
+                        single[i]=(uint32_t)s|((uint32_t)length<<16);
+                    }
+                }
+            }
+            // Pair each entry's symbol with the one its leftover bits start
+            table.assign(size,0);
+            for(int i=0;i<size;i++){
+                uint32_t first=single[i];
+                int length=first>>16;
+                if(length==0){
+                    continue;
+                }
+                uint32_t second=single[(i<<length)&(size-1)];
+                int secondLength=second>>16;
+                if(secondLength>0 && length+secondLength<=TABLE_BITS){
+                    table[i]=(first&0xFF)|((second&0xFF)<<8)|((uint32_t)length<<16)|((uint32_t)(length+secondLength)<<20)|(2u<<24);
+                }
+                else{
+                    table[i]=(first&0xFF)|((uint32_t)length<<16)|((uint32_t)length<<20)|(1u<<24);
+                }
+            }
+            return true;
+        }
+
+        // Bits that must be buffered before each Decode
+        int GetMaxLength() const{
+            return maxLength;
+        }
+
+        // The next symbol, or -1 if the bits are no code
+        int Decode(BitReader& reader) const{
+            uint32_t entry=table[reader.Peek(TABLE_BITS)];
+            if(entry>>24){
+                reader.Skip((entry>>16)&0xF);
+                return (int)(entry&0xFF);
+            }
+            return DecodeLong(reader);
+        }
+
+        // Decodes count symbols into out; false if the bits are no code.
+        // Works on local copies so the stores to out cannot force the
+        // reader and table to be reloaded for every symbol.
+        template<class Symbol>
+        bool DecodeSymbols(BitReader& reader, Symbol* out, size_t count) const{
+            BitReader local=reader;
+            const uint32_t* lookup=table.data();
+            // A pair is only trusted when all TABLE_BITS are real data
+            int need=maxLength>TABLE_BITS ? maxLength : TABLE_BITS;
+            size_t i=0;
+            while(i<count){
+                local.Refill();
+                if(i+1==count){
+                    int symbol=Decode(local);
+                    if(symbol<0){
+                        return false;
+                    }
+                    out[i++]=(Symbol)symbol;
+                    break;
+                }
+                // A refill holds at least 56 bits: when codes are short
+                // enough that is four steps with no checks in between
+                if(4*need<=56){
+                    while(i+8<=count && local.Available()>=4*need){
+                        for(int step=0;step<4;step++){
+                            if(!DecodeStep(local,lookup,out,i)){
+                                return false;
+                            }
+                        }
+                        local.Refill();
+                    }
+                }
+                while(local.Available()>=need && i+1<count){
+                    if(!DecodeStep(local,lookup,out,i)){
+                        return false;
+                    }
+                }
+            }
+            reader=local;
+            return true;
+        }
+
+        // Decodes N independent streams together, count[k] symbols of
+        // reader[k] into out[k]. One stream is a chain: each lookup waits
+        // for the length the one before it found. N chains in lockstep
+        // keep N lookups in flight at once. While every stream has 8 bytes
+        // left to load and room for a round, all readers are refilled
+        // without checks and each takes as many steps as 56 bits allow.
+        // The loops over streams are unrolled, so the readers are only
+        // ever indexed by constants and can be kept apart from the memory
+        // the symbol stores might alias. The ends of the streams go one
+        // at a time.
+        template<int N, class Symbol>
+        bool DecodeInterleaved(BitReader reader[N], Symbol* const out[N], const size_t count[N]) const{
+            BitReader local[N];
+            Symbol* next[N];
+#pragma GCC unroll 8
+            for(int k=0;k<N;k++){
+                local[k]=reader[k];
+                next[k]=out[k];
+            }
+            const uint32_t* lookup=table.data();
+            int need=maxLength>TABLE_BITS ? maxLength : TABLE_BITS;
+            int steps=56/need;
+            // A step writes up to two symbols
+            size_t room=2*(size_t)steps+1;
+            while(true){
+                bool fits=true;
+#pragma GCC unroll 8
+                for(int k=0;k<N;k++){
+                    fits&=(size_t)(out[k]+count[k]-next[k])>=room && local[k].Remaining()>=8;
+                }
+                if(!fits){
+                    break;
+                }
+#pragma GCC unroll 8
+                for(int k=0;k<N;k++){
+                    local[k].RefillFast();
+                }
+                for(int step=0;step<steps;step++){
+#pragma GCC unroll 8
+                    for(int k=0;k<N;k++){
+                        uint32_t entry=lookup[local[k].Peek(TABLE_BITS)];
+                        if(entry>>24){
+                            next[k][0]=(Symbol)(entry&0xFF);
+                            next[k][1]=(Symbol)((entry>>8)&0xFF);
+                            next[k]+=entry>>24;
+                            local[k].Skip((entry>>20)&0xF);
+                            continue;
+                        }
+                        int symbol=DecodeLong(local[k]);
+                        if(symbol<0){
+                            return false;
+                        }
+                        *next[k]++=(Symbol)symbol;
+                    }
+                }
+            }
+            // The tails go through reader[], so that local[] is never
+            // referenced from outside and can live in registers
+#pragma GCC unroll 8
+            for(int k=0;k<N;k++){
+                reader[k]=local[k];
+            }
+            for(int k=0;k<N;k++){
+                if(!DecodeSymbols(reader[k],next[k],(size_t)(out[k]+count[k]-next[k]))){
+                    return false;
+                }
+            }
+            return true;
+        }
+};
+
+#endif
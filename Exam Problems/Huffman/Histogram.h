@@ -0,0 +1,56 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+using namespace std;
+
+// Adds the byte counts of data[0..length) to counts. With one counter per
+// byte value a run of equal bytes makes every increment wait for the
+// previous store to the same counter. Four sub-histograms take the bytes
+// in turn, so the increments of a run go to four different counters and
+// overlap. The loop reads 16 bytes at a time as two words and picks the
+// bytes out with shifts; which byte lands in which sub-histogram does not
+// matter, so this works in either byte order.
+inline void CountBytes(const uint8_t* data, size_t length, uint64_t counts[256]){
+    uint32_t sub[4][256];
+    while(length>0){
+        // 32-bit counters cannot overflow within a piece
+        size_t n=length<((size_t)1<<32)-16 ? length : ((size_t)1<<32)-16;
+        memset(sub,0,sizeof(sub));
+        size_t i=0;
+        for(;i+16<=n;i+=16){
+            uint64_t a;
+            uint64_t b;
+            memcpy(&a,data+i,8);
+            memcpy(&b,data+i+8,8);
+            sub[0][(uint8_t)a]++;
+            sub[1][(uint8_t)(a>>8)]++;
+            sub[2][(uint8_t)(a>>16)]++;
+            sub[3][(uint8_t)(a>>24)]++;
+            sub[0][(uint8_t)(a>>32)]++;
+            sub[1][(uint8_t)(a>>40)]++;
+            sub[2][(uint8_t)(a>>48)]++;
+            sub[3][(uint8_t)(a>>56)]++;
+            sub[0][(uint8_t)b]++;
+            sub[1][(uint8_t)(b>>8)]++;
+            sub[2][(uint8_t)(b>>16)]++;
+            sub[3][(uint8_t)(b>>24)]++;
+            sub[0][(uint8_t)(b>>32)]++;
+            sub[1][(uint8_t)(b>>40)]++;
+            sub[2][(uint8_t)(b>>48)]++;
+            sub[3][(uint8_t)(b>>56)]++;
+        }
+        for(;i<n;i++){
+            sub[i&3][data[i]]++;
+        }
+        for(int s=0;s<256;s++){
+            counts[s]+=(uint64_t)sub[0][s]+sub[1][s]+sub[2][s]+sub[3][s];
+        }
+        data+=n;
+        length-=n;
+    }
+}
+
+#endif
@@ -1,287 +1,99 @@
 #include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include "HuffmanTree.h"
+#include "HuffmanCodec.h"
+#include "ParallelHuffman.h"
+#include "AdaptiveHuffman.h"
+#include "LzHuffman.h"
 using namespace std;
 
-struct Character{
-    
-    char character;
-    int frequency=1;
-    string code="";
-    Character* parent;
-    Character* left;
-    Character* right;
-    
-    Character(char c){
-        character=c;
-        parent=left=right=nullptr;
+const int MAX_THREADS=256;
+
+// Compresses or decompresses inFile into outFile and reports the sizes and
+// throughput on stderr
+template<class Codec>
+int RunCodec(Codec& codec, bool compress, string inFile, string outFile){
+    auto begin=chrono::steady_clock::now();
+    bool ok=compress ? codec.CompressFile(inFile,outFile) : codec.DecompressFile(inFile,outFile);
+    double seconds=chrono::duration<double>(chrono::steady_clock::now()-begin).count();
+    if(!ok){
+        cerr<<"Error: Could not "<<(compress ? "compress " : "decompress ")<<inFile<<endl;
+        return 1;
     }
-    Character(){
-        parent=left=right=nullptr;
+    const HuffmanStats& stats=codec.GetStats();
+    long long rawBytes=compress ? stats.inputBytes : stats.outputBytes;
+    cerr<<stats.inputBytes<<" -> "<<stats.outputBytes<<" bytes in "<<stats.blocks<<" blocks";
+    if(compress && stats.inputBytes>0){
+        cerr<<" ("<<100.0*stats.outputBytes/stats.inputBytes<<"%, "<<stats.headerBytes<<" header bytes)";
     }
-    int GetFreq(){
-        return frequency;
+    cerr<<endl;
+    cerr<<"Time: "<<seconds*1000<<" ms, "<<rawBytes/1e6/(seconds>0 ? seconds : 1e-9)<<" MB/s"<<endl;
+    return 0;
+}
+
+// Reads argument index of argv as an int in [low, high] into value, or
+// keeps value when there is no such argument. False on anything else.
+bool ParseArgument(int argc, char* argv[], int index, int low, int high, int& value){
+    if(index>=argc){
+        return true;
     }
-    char GetChar(){
-        return character;
+    char* end;
+    long parsed=strtol(argv[index],&end,10);
+    if(end==argv[index] || *end!='\0' || parsed<low || parsed>high){
+        cerr<<"Error: "<<argv[index]<<" is not a number from "<<low<<" to "<<high<<endl;
+        return false;
     }
-    void IncFreq(){
-        frequency++;
+    value=(int)parsed;
+    return true;
+}
+
+// Usage: Huffman                               prints the codes of the demo message
+//        Huffman --compress input output [maxCodeLength] [streams]
+//        Huffman --decompress input output
+//        Huffman --parallel-compress input output [threads] [maxCodeLength]
+//        Huffman --parallel-decompress input output [threads]
+//        Huffman --adaptive-compress input output      one pass, e.g. from /dev/stdin
+//        Huffman --adaptive-decompress input output
+//        Huffman --lz-compress input output            LZ77 tokens, Huffman coded
+//        Huffman --lz-decompress input output
+int main(int argc, char* argv[]){
+    string mode=argc>=2 ? argv[1] : "";
+    if(argc>=4 && (mode=="--compress" || mode=="--decompress")){
+        int maxLength=MAX_CODE_LENGTH;
+        int streams=HuffmanCodec::DEFAULT_STREAMS;
+        if(!ParseArgument(argc,argv,4,1,MAX_CODE_LENGTH,maxLength)
+           || !ParseArgument(argc,argv,5,1,HuffmanCodec::MAX_STREAMS,streams)){
+            return 1;
+        }
+        if(!HuffmanCodec::ValidStreams(streams)){
+            cerr<<"Error: streams must be 1, 2, 4 or 8"<<endl;
+            return 1;
+        }
+        HuffmanCodec codec(HuffmanCodec::DEFAULT_BLOCK_SIZE,maxLength,streams);
+        return RunCodec(codec,mode=="--compress",argv[2],argv[3]);
     }
-    void SetFreq(int num){
-        frequency=num;
+    if(argc>=4 && (mode=="--parallel-compress" || mode=="--parallel-decompress")){
+        int threads=(int)thread::hardware_concurrency();
+        int maxLength=MAX_CODE_LENGTH;
+        if(!ParseArgument(argc,argv,4,1,MAX_THREADS,threads) || !ParseArgument(argc,argv,5,1,MAX_CODE_LENGTH,maxLength)){
+            return 1;
+        }
+        ParallelHuffmanCodec codec(threads,ParallelHuffmanCodec::DEFAULT_SEGMENT_SIZE,ParallelHuffmanCodec::DEFAULT_CHUNK_SIZE,maxLength);
+        return RunCodec(codec,mode=="--parallel-compress",argv[2],argv[3]);
     }
-    void AppendToCode(char c){
-        code+=c;
+    if(argc>=4 && (mode=="--adaptive-compress" || mode=="--adaptive-decompress")){
+        AdaptiveHuffmanCodec codec;
+        return RunCodec(codec,mode=="--adaptive-compress",argv[2],argv[3]);
     }
-    string GetCode(){
-        return code;
+    if(argc>=4 && (mode=="--lz-compress" || mode=="--lz-decompress")){
+        LzHuffmanCodec codec;
+        return RunCodec(codec,mode=="--lz-compress",argv[2],argv[3]);
     }
-};
-
-class Table{
-    private:
-        int size;
-        int capacity;
-        Character** table;
-    public:
-        Table(){
-            size=0;
-            capacity=256;
-            table=new Character*[capacity];
-            for(int i=0;i<capacity;i++){
-                table[i]=nullptr;
-            }
-        }
-        ~Table(){
-            for(int i=0;i<capacity;i++){
-                if(table[i]!=nullptr){
-                    delete table[i];
-                }
-            }
-            delete[] table;
-        }
-        int GetSize(){
-            return size;
-        }
-        int GetCapacity(){
-            return capacity;
-        }
-        Character* GetAt(int index){
-            return table[index];
-        }
-        void Insert(Character c){
-            int key=(unsigned char)c.GetChar();
-            if(table[key]==nullptr){
-                table[key]=new Character(c);
-                size++;
-            }
-            else{
-                table[key]->IncFreq();
-            }
-        }
-        void BuildTable(string msg){
-            for(int i=0;i<msg.length();i++){
-                Character c(msg[i]);
-                Insert(c);
-            }
-        }
-};
-
-class QueueException : public exception{
-    private:
-        string message;
-    public:
-        QueueException(const string& msg){
-            message=msg;
-        }
-        const char* what() const noexcept override{
-            return message.c_str();
-        }
-};
-
-class PQueue{
-    private:
-        int size;
-        int capacity;
-        Character** pqueue;
-    public:
-        PQueue(int cap){
-            size=0;
-            capacity=cap*2;
-            pqueue=new Character* [capacity];
-            for(int i=0;i<capacity;i++){
-                pqueue[i]=nullptr;
-            }
-        }
-        ~PQueue(){
-            delete[] pqueue;
-        }
-        int GetSize(){
-            return size;
-        }
-        void MinHeapPercolateUp(){
-            int index=size-1;
-            while(index>0){
-                int parentIndex=(index-1)/2;
-                if(pqueue[index]->GetFreq()>=pqueue[parentIndex]->GetFreq()){
-                    return;
-                }
-                else{
-                    Character* temp=pqueue[index];
-                    pqueue[index]=pqueue[parentIndex];
-                    pqueue[parentIndex]=temp;
-                    index=parentIndex;
-                }
-            }
-        }
-        void MinHeapPercolateDown(){
-            int index=0;
-            int childIndex=index*2+1;
-            int value=pqueue[index]->GetFreq();
-            while(childIndex<size){
-                int minValue=value;
-                int minIndex=-1;
-                for(int i=0; i<2 && i+childIndex<size; i++){
-                    if(pqueue[i+childIndex]->GetFreq()<minValue){
-                        minValue=pqueue[i+childIndex]->GetFreq();
-                        minIndex=i+childIndex;
-                    }
-                }
-                if(minValue==value){
-                    return;
-                }
-                else{
-                    Character* temp=pqueue[index];
-                    pqueue[index]=pqueue[minIndex];
-                    pqueue[minIndex]=temp;
-                    index=minIndex;
-                    childIndex=2*index+1;
-                }
-            }
-        }
-        void Enqueue(Character* c){
-            if(size==0){
-                pqueue[0]=c;
-                size++;
-                return;
-            }
-            else{
-                pqueue[size]=c;
-                size++;
-                MinHeapPercolateUp();
-                return;
-            }
-        }
-        Character* Dequeue(){
-            if(size==0){
-                throw QueueException("Queue is empty");
-            }
-            else if(size==1){
-                Character* c=pqueue[0];
-                pqueue[0]=nullptr;
-                size--;
-                return c;
-            }
-            else if(size==2){
-                Character* c=pqueue[0];
-                pqueue[0]=pqueue[1];
-                pqueue[1]=nullptr;
-                size--;
-                return c;
-            }
-            else{
-                Character* c=pqueue[0];
-                pqueue[0]=pqueue[size-1];
-                pqueue[size-1]=nullptr;
-                size--;
-                MinHeapPercolateDown();
-                return c;
-            }
-        }
-};
-
-class HuffmanTree{
-    private:
-        Character* root;
-        Table freqTable;
-        string message;
-    public:
-        HuffmanTree(string msg){
-            root=nullptr;
-            message=msg;
-            freqTable.BuildTable(message);
-        }
-        ~HuffmanTree(){
-            RemovePostOrder(root);
-        }
-        void RemovePostOrder(Character* character){
-            if(character==nullptr){
-                return;
-            }
-            RemovePostOrder(character->left);
-            RemovePostOrder(character->right);
-            if(character->left!=nullptr || character->right!=nullptr){
-                delete character;
-            }
-        }
-        Character* HuffmanBuildTree(){
-            int priorityQueueSize=freqTable.GetSize();
-            PQueue characters(priorityQueueSize);
-            for(int i=0;i<freqTable.GetCapacity();i++){
-                if(freqTable.GetAt(i)!=nullptr){
-                    characters.Enqueue(freqTable.GetAt(i));
-                }
-            }
-            if(characters.GetSize()==1){
-                root=new Character();
-                Character* left=characters.Dequeue();
-                root->SetFreq(left->GetFreq());
-                root->left=left;
-                left->parent=root;
-                return root;
-            }
-            while(characters.GetSize()>1){
-                Character* left=characters.Dequeue();
-                Character* right=characters.Dequeue();
-                Character* parent=new Character();
-                parent->SetFreq(left->GetFreq()+right->GetFreq());
-                parent->left=left;
-                parent->right=right;
-                left->parent=parent;
-                right->parent=parent;
-                characters.Enqueue(parent);
-            }
-            root=characters.Dequeue();
-            return root;
-        }
-        void HuffmanSetCodes(Character* character, string prefix){
-            if(character==nullptr){
-                return;
-            }
-            else if(character->left==nullptr && character->right==nullptr){
-                int index=(unsigned char)character->character;
-                freqTable.GetAt(index)->code=prefix;
-            }
-            else{
-                HuffmanSetCodes(character->left, prefix+'0');
-                HuffmanSetCodes(character->right, prefix+'1');
-            }
-        }
-        string HuffmanGetCode(){
-            HuffmanSetCodes(HuffmanBuildTree(), "");
-            string result="";
-            for(int i=0;i<message.length();i++){
-                int index=(unsigned char)message[i];
-                result+=freqTable.GetAt(index)->code;
-                result+=" ";
-            }
-            return result;
-        }
-
-};
-
-int main(){
     HuffmanTree tree1("abbcccddddeeeeeffffffgggggggghhhhhhhhhhh");
     cout<<tree1.HuffmanGetCode();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,331 @@
+#ifndef HUFFMANCODEC_H
+#define HUFFMANCODEC_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include "HuffmanTree.h"
+#include "CanonicalCode.h"
+#include "LengthLimited.h"
+#include "BitStream.h"
+using namespace std;
+
+// Layout of a compressed stream: this header, then blocks of
+//   uint32 rawLength, uint32 encodedLength, encodedLength bytes
+// ending with a rawLength of 0. Every block carries its own code table,
+// so the coder adapts to the data as it changes and needs one block of
+// memory whatever the file size. An encoded block is
+//   uint16 numSymbols, then per symbol uint8 symbol, uint8 length, then
+//   with numStreams above 1 uint32 streamEnd[numStreams-1], the payload
+//   offset where each stream but the last stops, then the payload with
+//   canonical codes packed most significant bit first. The block's bytes
+//   are cut into numStreams runs of equal length (the last may be
+//   shorter), each coded as its own stream starting on a byte boundary,
+//   with the last byte padded with zeros. A numSymbols of 0 marks a
+//   stored block, used when coding would not make the data smaller, and is
+//   followed by the raw bytes.
+struct HuffmanFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t numStreams;
+};
+
+const char HUF_MAGIC[4]={'H','U','F','B'};
+// Version 1 stored every code's bits; version 2 only the lengths; version
+// 3 added the streams
+const uint32_t HUF_VERSION=3;
+
+struct HuffmanStats{
+    long long inputBytes=0;
+    long long outputBytes=0;
+    // File header, block framing and code tables: everything but payload
+    long long headerBytes=0;
+    int blocks=0;
+};
+
+class HuffmanCodec{
+    private:
+        size_t blockSize;
+        int maxCodeLength;
+        int numStreams;
+        vector<uint8_t> raw;
+        vector<uint8_t> encoded;
+        HuffmanStats stats;
+
+    public:
+        static const size_t DEFAULT_BLOCK_SIZE=1<<20;
+        // Bounds the code length: a code of L bits needs a block of at
+        // least Fibonacci(L+2) bytes, so 4 MiB blocks keep codes within 31
+        // bits and a 32-bit Put always suffices
+        static const size_t MAX_BLOCK_SIZE=1<<22;
+        // Streams per block: 1, 2, 4 or 8
+        static const int MAX_STREAMS=8;
+        static const int DEFAULT_STREAMS=4;
+
+        static bool ValidStreams(int streams){
+            return streams==1 || streams==2 || streams==4 || streams==8;
+        }
+        // Stream k of a block covers data[StreamBegin..StreamBegin+StreamLength)
+        static size_t StreamBegin(size_t length, int streams, int k){
+            size_t run=(length+streams-1)/streams;
+            return (size_t)k*run<length ? (size_t)k*run : length;
+        }
+        static size_t StreamLength(size_t length, int streams, int k){
+            return StreamBegin(length,streams,k+1)-StreamBegin(length,streams,k);
+        }
+
+        // maxLength limits the code length, e.g. to 11 so that the decoder
+        // never leaves its first table. streams is rounded down to 1, 2, 4
+        // or 8.
+        HuffmanCodec(size_t block=DEFAULT_BLOCK_SIZE, int maxLength=MAX_CODE_LENGTH, int streams=DEFAULT_STREAMS){
+            blockSize=block<1 ? 1 : (block>MAX_BLOCK_SIZE ? MAX_BLOCK_SIZE : block);
+            maxCodeLength=maxLength;
+            numStreams=1;
+            while(numStreams*2<=streams && numStreams<MAX_STREAMS){
+                numStreams*=2;
+            }
+        }
+
+        // Replaces out with data[0..length) as one encoded block of the
+        // given number of streams: code table, stream ends and payload.
+        // length must be between 1 and MAX_BLOCK_SIZE.
+        static void EncodeBlock(const uint8_t* data, size_t length, vector<uint8_t>& out, int maxLength=MAX_CODE_LENGTH, int streams=1){
+            // Per-stream counts give each stream's exact size up front
+            uint64_t streamCounts[MAX_STREAMS][256]={{0}};
+            uint64_t counts[256]={0};
+            for(int k=0;k<streams;k++){
+                CountBytes(data+StreamBegin(length,streams,k),StreamLength(length,streams,k),streamCounts[k]);
+                for(int s=0;s<256;s++){
+                    counts[s]+=streamCounts[k][s];
+                }
+            }
+            int lengths[256];
+            LimitedCodeLengths(counts,lengths,maxLength);
+            HuffmanCode codes[256];
+            bool coded=AssignCanonicalCodes(lengths,256,codes);
+
+            int numSymbols=0;
+            for(int s=0;s<256;s++){
+                numSymbols+=counts[s]>0 ? 1 : 0;
+            }
+            uint32_t streamEnd[MAX_STREAMS];
+            uint64_t end=0;
+            for(int k=0;k<streams;k++){
+                uint64_t bits=0;
+                for(int s=0;s<256;s++){
+                    bits+=streamCounts[k][s]*lengths[s];
+                }
+                end+=(bits+7)/8;
+                streamEnd[k]=(uint32_t)end;
+            }
+            size_t tableBytes=2+2*(size_t)numSymbols;
+            size_t payloadAt=tableBytes+4*(size_t)(streams-1);
+            // Lengths no canonical code can hold are stored raw as well
+            if(!coded || payloadAt+end>=2+length){
+                out.assign(2+length,0);
+                memcpy(out.data()+2,data,length);
+                return;
+            }
+            out.resize(payloadAt+(size_t)end);
+            uint16_t n=(uint16_t)numSymbols;
+            memcpy(out.data(),&n,2);
+            size_t at=2;
+            for(int s=0;s<256;s++){
+                if(counts[s]>0){
+                    out[at]=(uint8_t)s;
+                    out[at+1]=(uint8_t)codes[s].length;
+                    at+=2;
+                }
+            }
+            memcpy(out.data()+tableBytes,streamEnd,4*(size_t)(streams-1));
+
+            uint8_t* payload=out.data()+payloadAt;
+            for(int k=0;k<streams;k++){
+                const uint8_t* run=data+StreamBegin(length,streams,k);
+                size_t runLength=StreamLength(length,streams,k);
+                BitWriter writer(payload+(k>0 ? streamEnd[k-1] : 0));
+                for(size_t i=0;i<runLength;i++){
+                    const HuffmanCode& code=codes[run[i]];
+                    writer.Put(code.bits,code.length);
+                }
+                writer.Flush();
+            }
+        }
+
+        // Decodes one block of the given number of streams into
+        // out[0..rawLength); false if it is corrupt
+        static bool DecodeBlock(const uint8_t* in, size_t inLength, uint8_t* out, size_t rawLength, int streams=1){
+            if(inLength<2){
+                return false;
+            }
+            uint16_t n;
+            memcpy(&n,in,2);
+            int numSymbols=n;
+            if(numSymbols==0){
+                if(inLength!=2+rawLength){
+                    return false;
+                }
+                memcpy(out,in+2,rawLength);
+                return true;
+            }
+            size_t tableBytes=2+2*(size_t)numSymbols;
+            size_t payloadAt=tableBytes+4*(size_t)(streams-1);
+            if(numSymbols>256 || !ValidStreams(streams) || inLength<payloadAt){
+                return false;
+            }
+            int lengths[256]={0};
+            for(int k=0;k<numSymbols;k++){
+                int s=in[2+2*k];
+                int length=in[3+2*k];
+                if(length<1 || lengths[s]!=0){
+                    return false;
+                }
+                lengths[s]=length;
+            }
+            HuffmanDecoder decoder;
+            if(!decoder.Build(lengths,256)){
+                return false;
+            }
+
+            uint32_t streamEnd[MAX_STREAMS];
+            memcpy(streamEnd,in+tableBytes,4*(size_t)(streams-1));
+            streamEnd[streams-1]=(uint32_t)(inLength-payloadAt);
+            BitReader readers[MAX_STREAMS];
+            uint8_t* outs[MAX_STREAMS];
+            size_t counts[MAX_STREAMS];
+            uint32_t previous=0;
+            for(int k=0;k<streams;k++){
+                if(streamEnd[k]<previous || streamEnd[k]>inLength-payloadAt){
+                    return false;
+                }
+                readers[k]=BitReader(in+payloadAt+previous,streamEnd[k]-previous);
+                outs[k]=out+StreamBegin(rawLength,streams,k);
+                counts[k]=StreamLength(rawLength,streams,k);
+                previous=streamEnd[k];
+            }
+            bool ok;
+            switch(streams){
+                case 2:
+                    ok=decoder.DecodeInterleaved<2>(readers,outs,counts);
+                    break;
+                case 4:
+                    ok=decoder.DecodeInterleaved<4>(readers,outs,counts);
+                    break;
+                case 8:
+                    ok=decoder.DecodeInterleaved<8>(readers,outs,counts);
+                    break;
+                default:
+                    ok=decoder.DecodeSymbols(readers[0],out,rawLength);
+                    break;
+            }
+            for(int k=0;k<streams;k++){
+                ok=ok && !readers[k].Overrun();
+            }
+            return ok;
+        }
+
+        bool Compress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            HuffmanFileHeader header;
+            memcpy(header.magic,HUF_MAGIC,4);
+            header.version=HUF_VERSION;
+            header.blockSize=(uint32_t)blockSize;
+            header.numStreams=(uint32_t)numStreams;
+            out.write((const char*)&header,sizeof(header));
+            stats.outputBytes+=sizeof(header);
+            stats.headerBytes+=sizeof(header);
+
+            raw.resize(blockSize);
+            while(true){
+                in.read((char*)raw.data(),blockSize);
+                size_t length=(size_t)in.gcount();
+                if(length==0){
+                    break;
+                }
+                EncodeBlock(raw.data(),length,encoded,maxCodeLength,numStreams);
+                uint32_t frame[2]={(uint32_t)length,(uint32_t)encoded.size()};
+                out.write((const char*)frame,sizeof(frame));
+                out.write((const char*)encoded.data(),encoded.size());
+                uint16_t numSymbols;
+                memcpy(&numSymbols,encoded.data(),2);
+                stats.inputBytes+=length;
+                stats.outputBytes+=sizeof(frame)+encoded.size();
+                stats.headerBytes+=sizeof(frame)+2;
+                if(numSymbols>0){
+                    stats.headerBytes+=2*(size_t)numSymbols+4*(size_t)(numStreams-1);
+                }
+                stats.blocks++;
+            }
+            uint32_t end=0;
+            out.write((const char*)&end,sizeof(end));
+            stats.outputBytes+=sizeof(end);
+            stats.headerBytes+=sizeof(end);
+            return !in.bad() && (bool)out;
+        }
+
+        bool Decompress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            HuffmanFileHeader header;
+            if(!in.read((char*)&header,sizeof(header)) || memcmp(header.magic,HUF_MAGIC,4)!=0
+               || header.version!=HUF_VERSION || header.blockSize>MAX_BLOCK_SIZE
+               || header.numStreams>MAX_STREAMS || !ValidStreams((int)header.numStreams)){
+                return false;
+            }
+            stats.inputBytes+=sizeof(header);
+            while(true){
+                uint32_t rawLength;
+                if(!in.read((char*)&rawLength,sizeof(rawLength))){
+                    return false;
+                }
+                stats.inputBytes+=sizeof(rawLength);
+                if(rawLength==0){
+                    break;
+                }
+                uint32_t encodedLength;
+                // A block never holds more than the header's block size, and
+                // is stored raw rather than grow past its table plus the data
+                if(rawLength>header.blockSize || !in.read((char*)&encodedLength,sizeof(encodedLength))
+                   || encodedLength>2+2*256+4*(MAX_STREAMS-1)+(uint64_t)rawLength){
+                    return false;
+                }
+                encoded.resize(encodedLength);
+                raw.resize(rawLength);
+                if(!in.read((char*)encoded.data(),encodedLength)
+                   || !DecodeBlock(encoded.data(),encodedLength,raw.data(),rawLength,(int)header.numStreams)){
+                    return false;
+                }
+                out.write((const char*)raw.data(),rawLength);
+                stats.inputBytes+=sizeof(encodedLength)+encodedLength;
+                stats.outputBytes+=rawLength;
+                stats.blocks++;
+            }
+            return (bool)out;
+        }
+
+        bool CompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Compress(in,out);
+        }
+        bool DecompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Decompress(in,out);
+        }
+
+        const HuffmanStats& GetStats() const{
+            return stats;
+        }
+        size_t GetBlockSize() const{
+            return blockSize;
+        }
+        int GetNumStreams() const{
+            return numStreams;
+        }
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef HUFFMANTREE_H
+#define HUFFMANTREE_H
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "Histogram.h"
+using namespace std;
+
+// A symbol's code as an integer: the low length bits of bits, most
+// significant bit first
+struct HuffmanCode{
+    uint32_t bits;
+    int length;
+};
+
+// Node of a Huffman tree in HuffmanTree's arena. Children are indices
+// into the same arena; 16 bits cover the 2*256-1 nodes of a byte
+// alphabet.
+struct HuffmanNode{
+    uint64_t frequency;
+    uint16_t left;
+    uint16_t right;
+    uint16_t symbol;
+};
+
+// Byte frequencies in a flat array. Leaves are only made for the bytes
+// that occur, when the tree is built.
+class Table{
+    private:
+        int size;
+        int capacity;
+        uint64_t counts[256];
+
+        void CountSymbols(){
+            size=0;
+            for(int i=0;i<capacity;i++){
+                size+=counts[i]>0 ? 1 : 0;
+            }
+        }
+    public:
+        Table(){
+            size=0;
+            capacity=256;
+            for(int i=0;i<capacity;i++){
+                counts[i]=0;
+            }
+        }
+        int GetSize(){
+            return size;
+        }
+        int GetCapacity(){
+            return capacity;
+        }
+        uint64_t GetCount(int index){
+            return counts[index];
+        }
+        void BuildTable(string msg){
+            CountBytes((const uint8_t*)msg.data(),msg.length(),counts);
+            CountSymbols();
+        }
+        // From byte counts that were already gathered, e.g. for one block
+        void BuildTable(const uint64_t byteCounts[256]){
+            for(int i=0;i<capacity;i++){
+                counts[i]=byteCounts[i];
+            }
+            CountSymbols();
+        }
+};
+
+// Builds the tree in a fixed array of nodes, so a tree costs no heap
+// allocation however often it is rebuilt; the block coders make one per
+// block. Leaves are sorted by frequency once, and then the two-queue
+// method merges in linear time: merged nodes come out in nondecreasing
+// frequency order, so the two smallest nodes are always at the heads of
+// the sorted leaves and of the merged nodes. On a tie the leaf goes
+// first, which keeps the longest code as short as possible. The coders
+// only use the code lengths, so how ties fall does not matter to them.
+//
+// HuffmanGetCode prints the codes themselves, and those must match the
+// ones ExpectedLength.txt works out by hand. It builds the tree with a
+// binary min-heap of arena indices instead, filled with the leaves in
+// symbol order, that breaks ties exactly as the original pointer-based
+// PQueue did.
+class HuffmanTree{
+    private:
+        static const int MAX_NODES=2*256-1;
+        static const uint16_t NO_CHILD=0xFFFF;
+        HuffmanNode nodes[MAX_NODES];
+        int numNodes;
+        int root;
+        uint16_t heap[256];
+        int heapSize;
+        Table freqTable;
+        string message;
+        HuffmanCode codes[256];
+
+        int AddNode(uint64_t frequency, int left, int right, int symbol){
+            nodes[numNodes]={frequency,(uint16_t)left,(uint16_t)right,(uint16_t)symbol};
+            return numNodes++;
+        }
+        uint64_t HeapFrequency(int i) const{
+            return nodes[heap[i]].frequency;
+        }
+        // A new node stops below any parent of equal frequency
+        void HeapPush(int node){
+            int index=heapSize++;
+            heap[index]=(uint16_t)node;
+            while(index>0){
+                int parentIndex=(index-1)/2;
+                if(HeapFrequency(index)>=HeapFrequency(parentIndex)){
+                    return;
+                }
+                swap(heap[index],heap[parentIndex]);
+                index=parentIndex;
+            }
+        }
+        // The last node moves to the root and sinks only past a child
+        // strictly smaller than it, the left one when both are
+        int HeapPop(){
+            int top=heap[0];
+            heap[0]=heap[--heapSize];
+            int index=0;
+            uint64_t value=HeapFrequency(0);
+            while(2*index+1<heapSize){
+                int child=2*index+1;
+                int smallest=-1;
+                uint64_t minValue=value;
+                for(int k=child;k<child+2 && k<heapSize;k++){
+                    if(HeapFrequency(k)<minValue){
+                        minValue=HeapFrequency(k);
+                        smallest=k;
+                    }
+                }
+                if(smallest<0){
+                    break;
+                }
+                swap(heap[index],heap[smallest]);
+                index=smallest;
+            }
+            return top;
+        }
+        // The PQueue-compatible build behind HuffmanGetCode
+        int HuffmanBuildHeapTree(){
+            numNodes=0;
+            heapSize=0;
+            for(int i=0;i<freqTable.GetCapacity();i++){
+                if(freqTable.GetCount(i)>0){
+                    HeapPush(AddNode(freqTable.GetCount(i),NO_CHILD,NO_CHILD,i));
+                }
+            }
+            if(numNodes==0){
+                root=-1;
+                return root;
+            }
+            if(numNodes==1){
+                root=AddNode(nodes[0].frequency,0,NO_CHILD,0);
+                return root;
+            }
+            while(heapSize>1){
+                int left=HeapPop();
+                int right=HeapPop();
+                HeapPush(AddNode(nodes[left].frequency+nodes[right].frequency,left,right,0));
+            }
+            root=HeapPop();
+            return root;
+        }
+    public:
+        HuffmanTree(string msg){
+            numNodes=0;
+            root=-1;
+            message=msg;
+            freqTable.BuildTable(message);
+        }
+        HuffmanTree(const uint64_t counts[256]){
+            numNodes=0;
+            root=-1;
+            freqTable.BuildTable(counts);
+        }
+        // Returns the root's index, or -1 if no symbol occurs
+        int HuffmanBuildTree(){
+            numNodes=0;
+            for(int i=0;i<freqTable.GetCapacity();i++){
+                if(freqTable.GetCount(i)>0){
+                    AddNode(freqTable.GetCount(i),NO_CHILD,NO_CHILD,i);
+                }
+            }
+            int numLeaves=numNodes;
+            if(numLeaves==0){
+                root=-1;
+                return root;
+            }
+            // Ties in symbol order, so the tree does not depend on the sort
+            sort(nodes,nodes+numLeaves,[](const HuffmanNode& a, const HuffmanNode& b){
+                return a.frequency!=b.frequency ? a.frequency<b.frequency : a.symbol<b.symbol;
+            });
+            if(numLeaves==1){
+                root=AddNode(nodes[0].frequency,0,NO_CHILD,0);
+                return root;
+            }
+            int nextLeaf=0;
+            int nextMerged=numLeaves;
+            auto takeSmallest=[&](){
+                if(nextLeaf<numLeaves && (nextMerged==numNodes || nodes[nextLeaf].frequency<=nodes[nextMerged].frequency)){
+                    return nextLeaf++;
+                }
+                return nextMerged++;
+            };
+            for(int merges=0;merges<numLeaves-1;merges++){
+                int left=takeSmallest();
+                int right=takeSmallest();
+                AddNode(nodes[left].frequency+nodes[right].frequency,left,right,0);
+            }
+            root=numNodes-1;
+            return root;
+        }
+        // Every child sits below its parent in the arena, so one pass from
+        // the root down sets all codes without recursion. bits is only
+        // meaningful up to 32 bits; length is always right.
+        void HuffmanSetCodes(){
+            for(int i=0;i<256;i++){
+                codes[i]={0,0};
+            }
+            if(root<0){
+                return;
+            }
+            HuffmanCode path[MAX_NODES];
+            path[root]={0,0};
+            for(int i=root;i>=0;i--){
+                const HuffmanNode& node=nodes[i];
+                if(node.left==NO_CHILD){
+                    codes[node.symbol]=path[i];
+                    continue;
+                }
+                path[node.left]={path[i].bits<<1,path[i].length+1};
+                if(node.right!=NO_CHILD){
+                    path[node.right]={(path[i].bits<<1)|1,path[i].length+1};
+                }
+            }
+        }
+        // Codes for every symbol in the table; the others get length 0
+        void HuffmanGetCodes(HuffmanCode result[256]){
+            HuffmanBuildTree();
+            HuffmanSetCodes();
+            for(int i=0;i<256;i++){
+                result[i]=codes[i];
+            }
+        }
+        string HuffmanGetCode(){
+            HuffmanBuildHeapTree();
+            HuffmanSetCodes();
+            string result="";
+            for(size_t i=0;i<message.length();i++){
+                int index=(unsigned char)message[i];
+                HuffmanCode code=codes[index];
+                for(int bit=code.length-1;bit>=0;bit--){
+                    result+=(code.bits>>bit)&1 ? '1' : '0';
+                }
+                result+=" ";
+            }
+            return result;
+        }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef LENGTHLIMITED_H
+#define LENGTHLIMITED_H
+
+#include <cstdint>
+#include <algorithm>
+#include "HuffmanTree.h"
+#include "CanonicalCode.h"
+using namespace std;
+
+// Shortest limit that can hold numSymbols codes
+inline int MinCodeLength(int numSymbols){
+    int length=1;
+    while(((uint64_t)1<<length)<(uint64_t)numSymbols){
+        length++;
+    }
+    return length;
+}
+
+// Optimal code lengths with none above maxLength, by package-merge
+// (Larmore and Hirschberg). Level 0 is the sorted symbols. Every higher
+// level merges the symbols again with packages, each package pairing two
+// neighbouring items of the level below. The cheapest 2n-2 items of the
+// top level form the code. Going down, each selected symbol adds one to
+// its length, and each selected package selects its two items one level
+// lower. Raises maxLength to what the alphabet needs and caps it at
+// MAX_CODE_LENGTH. Works on the stack, like the tree.
+inline void PackageMergeLengths(const uint64_t counts[256], int lengths[256], int maxLength){
+    uint16_t symbols[256];
+    int n=0;
+    for(int s=0;s<256;s++){
+        lengths[s]=0;
+        if(counts[s]>0){
+            symbols[n++]=(uint16_t)s;
+        }
+    }
+    if(n<=1){
+        if(n==1){
+            lengths[symbols[0]]=1;
+        }
+        return;
+    }
+    sort(symbols,symbols+n,[&](uint16_t a, uint16_t b){
+        return counts[a]!=counts[b] ? counts[a]<counts[b] : a<b;
+    });
+    maxLength=max(maxLength,MinCodeLength(n));
+    maxLength=min(maxLength,MAX_CODE_LENGTH);
+
+    // item[level][i] is a symbol, or PACKAGE
+    const int16_t PACKAGE=-1;
+    int16_t item[MAX_CODE_LENGTH][2*256];
+    int size[MAX_CODE_LENGTH];
+    uint64_t weight[2][2*256];
+    for(int i=0;i<n;i++){
+        item[0][i]=(int16_t)symbols[i];
+        weight[0][i]=counts[symbols[i]];
+    }
+    size[0]=n;
+    for(int level=1;level<maxLength;level++){
+        const uint64_t* below=weight[(level-1)&1];
+        uint64_t* current=weight[level&1];
+        int packages=size[level-1]/2;
+        int i=0;
+        int j=0;
+        int k=0;
+        while(i<n || j<packages){
+            uint64_t package=j<packages ? below[2*j]+below[2*j+1] : 0;
+            if(j>=packages || (i<n && counts[symbols[i]]<=package)){
+                item[level][k]=(int16_t)symbols[i];
+                current[k++]=counts[symbols[i++]];
+            }
+            else{
+                item[level][k]=PACKAGE;
+                current[k++]=package;
+                j++;
+            }
+        }
+        size[level]=k;
+    }
+    int selected=2*n-2;
+    for(int level=maxLength-1;level>=0;level--){
+        int packages=0;
+        for(int i=0;i<selected;i++){
+            if(item[level][i]==PACKAGE){
+                packages++;
+            }
+            else{
+                lengths[item[level][i]]++;
+            }
+        }
+        selected=2*packages;
+    }
+}
+
+// Code lengths for byte counts with no code longer than maxLength, by
+// the older heuristic the benchmark compares package-merge against.
+// While the tree is too deep every count is halved, staying nonzero, and
+// the tree rebuilt: the flatter distribution shortens the longest codes
+// for a small loss in ratio. maxLength is raised to what the alphabet
+// needs, since once every count is 1 the tree cannot get any flatter.
+inline void HuffmanCodeLengths(const uint64_t counts[256], int lengths[256], int maxLength){
+    uint64_t scaled[256];
+    int numSymbols=0;
+    for(int s=0;s<256;s++){
+        scaled[s]=counts[s];
+        numSymbols+=counts[s]>0 ? 1 : 0;
+    }
+    maxLength=max(maxLength,MinCodeLength(numSymbols));
+    while(true){
+        HuffmanCode codes[256];
+        HuffmanTree tree(scaled);
+        tree.HuffmanGetCodes(codes);
+        int longest=0;
+        for(int s=0;s<256;s++){
+            lengths[s]=codes[s].length;
+            longest=lengths[s]>longest ? lengths[s] : longest;
+        }
+        if(longest<=maxLength){
+            return;
+        }
+        for(int s=0;s<256;s++){
+            if(scaled[s]>0){
+                scaled[s]=(scaled[s]+1)/2;
+            }
+        }
+    }
+}
+
+// Plain Huffman lengths when they already fit, package-merge otherwise.
+// maxLength is first brought into [MinCodeLength, MAX_CODE_LENGTH], so
+// the lengths always fit a canonical code.
+inline void LimitedCodeLengths(const uint64_t counts[256], int lengths[256], int maxLength){
+    int numSymbols=0;
+    for(int s=0;s<256;s++){
+        numSymbols+=counts[s]>0 ? 1 : 0;
+    }
+    maxLength=max(maxLength,MinCodeLength(numSymbols));
+    maxLength=min(maxLength,MAX_CODE_LENGTH);
+    HuffmanCode codes[256];
+    HuffmanTree tree(counts);
+    tree.HuffmanGetCodes(codes);
+    int longest=0;
+    for(int s=0;s<256;s++){
+        lengths[s]=codes[s].length;
+        longest=max(longest,lengths[s]);
+    }
+    if(longest>maxLength){
+        PackageMergeLengths(counts,lengths,maxLength);
+    }
+}
+
+// Payload bits the counts take with these lengths
+inline uint64_t EncodedBits(const uint64_t counts[256], const int lengths[256]){
+    uint64_t bits=0;
+    for(int s=0;s<256;s++){
+        bits+=counts[s]*lengths[s];
+    }
+    return bits;
+}
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef LZHUFFMAN_H
+#define LZHUFFMAN_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include "BitStream.h"
+#include "HuffmanCodec.h"
+#include "SymbolHuffman.h"
+using namespace std;
+
+// Lengths and distances as a bucket code plus extra bits, like Deflate's
+// but by one rule: values 0-3 are their own code, and every larger power
+// of two is split in two codes by the bit below its top bit.
+inline int BucketCode(uint32_t value){
+    if(value<4){
+        return (int)value;
+    }
+    int top=0;
+    while((value>>(top+1))!=0){
+        top++;
+    }
+    return 2*top+(int)((value>>(top-1))&1);
+}
+inline int BucketExtraBits(int code){
+    return code<4 ? 0 : code/2-1;
+}
+inline uint32_t BucketBase(int code){
+    return code<4 ? (uint32_t)code : (uint32_t)(2|(code&1))<<BucketExtraBits(code);
+}
+
+// Layout of an LZ stream: this header, then blocks framed as in
+// HuffmanCodec's stream. Blocks do not refer to each other. An encoded
+// block is
+//   uint32 numTokens, the literal/length code table, the distance code
+//   table (both as SymbolEncoder writes them), then the payload: per
+//   token its literal/length code, and for a match the length's extra
+//   bits, the distance code and the distance's extra bits.
+// A numTokens of 0 marks a stored block followed by the raw bytes.
+struct LzFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint32_t blockSize;
+};
+
+const char HUF_LZ_MAGIC[4]={'H','U','F','L'};
+const uint32_t HUF_LZ_VERSION=1;
+
+// LZ77 with Huffman-coded tokens, for repetitive data such as logs. A
+// greedy matcher with one hash table finds earlier copies of the next 4
+// or more bytes; symbols 0-255 of the literal/length alphabet are bytes
+// and 256 on are match length buckets. Codes are limited to 15 bits, so a
+// whole token fits in the 56 bits of one refill.
+class LzHuffmanCodec{
+    public:
+        static const int MIN_MATCH=4;
+        static const int MAX_MATCH=258;
+        static const uint32_t WINDOW_SIZE=1<<16;
+        static const int LENGTH_CODES=16;
+        static const int DISTANCE_CODES=32;
+        static const int LITERAL_LENGTH_SYMBOLS=256+LENGTH_CODES;
+        static const int MAX_LZ_CODE_LENGTH=15;
+        static const size_t DEFAULT_BLOCK_SIZE=1<<20;
+        static const size_t MAX_BLOCK_SIZE=1<<24;
+
+    private:
+        static const int HASH_BITS=16;
+
+        // length 0: a literal, value is the byte; otherwise value is the distance
+        struct Token{
+            uint32_t length;
+            uint32_t value;
+        };
+
+        size_t blockSize;
+        vector<uint8_t> raw;
+        vector<uint8_t> encoded;
+        vector<uint32_t> head;
+        vector<Token> tokens;
+        // Bytes of the last block's token count and code tables
+        size_t tableBytes=0;
+        SymbolEncoder<uint16_t,LITERAL_LENGTH_SYMBOLS> literalLengths;
+        SymbolEncoder<uint8_t,DISTANCE_CODES> distances;
+        HuffmanStats stats;
+
+        static uint32_t Hash(const uint8_t* p){
+            uint32_t word;
+            memcpy(&word,p,4);
+            return (word*2654435761u)>>(32-HASH_BITS);
+        }
+
+        // Greedy parse of data[0..length) into tokens. head holds the last
+        // position plus one of each hash, 0 for none.
+        void FindMatches(const uint8_t* data, size_t length){
+            tokens.clear();
+            head.assign((size_t)1<<HASH_BITS,0);
+            size_t i=0;
+            while(i<length){
+                if(i+MIN_MATCH<=length){
+                    uint32_t h=Hash(data+i);
+                    size_t candidate=head[h];
+                    head[h]=(uint32_t)(i+1);
+                    if(candidate>0 && i-(candidate-1)<=WINDOW_SIZE && memcmp(data+candidate-1,data+i,MIN_MATCH)==0){
+                        size_t from=candidate-1;
+                        size_t limit=length-i<(size_t)MAX_MATCH ? length-i : MAX_MATCH;
+                        size_t n=MIN_MATCH;
+                        while(n<limit && data[from+n]==data[i+n]){
+                            n++;
+                        }
+                        tokens.push_back({(uint32_t)n,(uint32_t)(i-from)});
+                        for(size_t j=i+1;j<i+n && j+MIN_MATCH<=length;j++){
+                            head[Hash(data+j)]=(uint32_t)(j+1);
+                        }
+                        i+=n;
+                        continue;
+                    }
+                }
+                tokens.push_back({0,data[i]});
+                i++;
+            }
+        }
+
+    public:
+        LzHuffmanCodec(size_t block=DEFAULT_BLOCK_SIZE){
+            blockSize=block<1 ? 1 : (block>MAX_BLOCK_SIZE ? MAX_BLOCK_SIZE : block);
+        }
+
+        // Replaces out with data[0..length) as one encoded block; length
+        // must be between 1 and MAX_BLOCK_SIZE. Not static, unlike
+        // HuffmanCodec's: the matcher and code tables are reused.
+        void EncodeBlock(const uint8_t* data, size_t length, vector<uint8_t>& out){
+            FindMatches(data,length);
+            literalLengths.Clear();
+            distances.Clear();
+            uint64_t extraBits=0;
+            for(const Token& token : tokens){
+                if(token.length==0){
+                    literalLengths.Add((uint16_t)token.value);
+                    continue;
+                }
+                int lengthCode=BucketCode(token.length-MIN_MATCH);
+                int distanceCode=BucketCode(token.value-1);
+                literalLengths.Add((uint16_t)(256+lengthCode));
+                distances.Add((uint8_t)distanceCode);
+                extraBits+=BucketExtraBits(lengthCode)+BucketExtraBits(distanceCode);
+            }
+            literalLengths.Build(MAX_LZ_CODE_LENGTH);
+            distances.Build(MAX_LZ_CODE_LENGTH);
+
+            out.assign(4,0);
+            uint32_t numTokens=(uint32_t)tokens.size();
+            memcpy(out.data(),&numTokens,4);
+            literalLengths.WriteTable(out);
+            distances.WriteTable(out);
+            tableBytes=out.size();
+            uint64_t payloadBits=literalLengths.PayloadBits()+distances.PayloadBits()+extraBits;
+            if(tableBytes+(payloadBits+7)/8>=4+length){
+                out.assign(4+length,0);
+                memcpy(out.data()+4,data,length);
+                tableBytes=4;
+                return;
+            }
+            out.resize(tableBytes+(size_t)((payloadBits+7)/8));
+            BitWriter writer(out.data()+tableBytes);
+            for(const Token& token : tokens){
+                if(token.length==0){
+                    literalLengths.Put((uint16_t)token.value,writer);
+                    continue;
+                }
+                uint32_t lengthValue=token.length-MIN_MATCH;
+                uint32_t distanceValue=token.value-1;
+                int lengthCode=BucketCode(lengthValue);
+                int distanceCode=BucketCode(distanceValue);
+                literalLengths.Put((uint16_t)(256+lengthCode),writer);
+                writer.Put(lengthValue-BucketBase(lengthCode),BucketExtraBits(lengthCode));
+                distances.Put((uint8_t)distanceCode,writer);
+                writer.Put(distanceValue-BucketBase(distanceCode),BucketExtraBits(distanceCode));
+            }
+            writer.Flush();
+        }
+
+        // Decodes one block into out[0..rawLength); false if it is corrupt
+        static bool DecodeBlock(const uint8_t* in, size_t inLength, uint8_t* out, size_t rawLength){
+            if(inLength<4){
+                return false;
+            }
+            uint32_t numTokens;
+            memcpy(&numTokens,in,4);
+            if(numTokens==0){
+                if(inLength!=4+rawLength){
+                    return false;
+                }
+                memcpy(out,in+4,rawLength);
+                return true;
+            }
+            if(numTokens>rawLength){
+                return false;
+            }
+            const uint8_t* at=in+4;
+            const uint8_t* end=in+inLength;
+            SymbolDecoder<uint16_t,LITERAL_LENGTH_SYMBOLS> literalLengthDecoder;
+            SymbolDecoder<uint8_t,DISTANCE_CODES> distanceDecoder;
+            if(!literalLengthDecoder.ReadTable(at,end,MAX_LZ_CODE_LENGTH)
+               || !distanceDecoder.ReadTable(at,end,MAX_LZ_CODE_LENGTH)){
+                return false;
+            }
+            BitReader reader(at,end-at);
+            size_t produced=0;
+            for(uint32_t t=0;t<numTokens;t++){
+                // At most 15+6+15+14 bits: one refill covers the token
+                reader.Refill();
+                uint16_t symbol;
+                if(!literalLengthDecoder.Decode(reader,symbol)){
+                    return false;
+                }
+                if(symbol<256){
+                    if(produced==rawLength){
+                        return false;
+                    }
+                    out[produced++]=(uint8_t)symbol;
+                    continue;
+                }
+                int lengthCode=symbol-256;
+                int extra=BucketExtraBits(lengthCode);
+                size_t length=MIN_MATCH+BucketBase(lengthCode);
+                if(extra>0){
+                    length+=reader.Peek(extra);
+                    reader.Skip(extra);
+                }
+                uint8_t distanceCode;
+                if(!distanceDecoder.Decode(reader,distanceCode)){
+                    return false;
+                }
+                extra=BucketExtraBits(distanceCode);
+                size_t distance=1+BucketBase(distanceCode);
+                if(extra>0){
+                    distance+=reader.Peek(extra);
+                    reader.Skip(extra);
+                }
+                if(distance>produced || length>rawLength-produced){
+                    return false;
+                }
+                // Byte by byte: the copy may overlap what it writes
+                const uint8_t* from=out+produced-distance;
+                for(size_t i=0;i<length;i++){
+                    out[produced+i]=from[i];
+                }
+                produced+=length;
+            }
+            return produced==rawLength && !reader.Overrun();
+        }
+
+        bool Compress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            LzFileHeader header;
+            memcpy(header.magic,HUF_LZ_MAGIC,4);
+            header.version=HUF_LZ_VERSION;
+            header.blockSize=(uint32_t)blockSize;
+            out.write((const char*)&header,sizeof(header));
+            stats.outputBytes+=sizeof(header);
+            stats.headerBytes+=sizeof(header);
+
+            raw.resize(blockSize);
+            while(true){
+                in.read((char*)raw.data(),blockSize);
+                size_t length=(size_t)in.gcount();
+                if(length==0){
+                    break;
+                }
+                EncodeBlock(raw.data(),length,encoded);
+                uint32_t frame[2]={(uint32_t)length,(uint32_t)encoded.size()};
+                out.write((const char*)frame,sizeof(frame));
+                out.write((const char*)encoded.data(),encoded.size());
+                stats.inputBytes+=length;
+                stats.outputBytes+=sizeof(frame)+encoded.size();
+                stats.headerBytes+=sizeof(frame)+tableBytes;
+                stats.blocks++;
+            }
+            uint32_t end=0;
+            out.write((const char*)&end,sizeof(end));
+            stats.outputBytes+=sizeof(end);
+            stats.headerBytes+=sizeof(end);
+            return !in.bad() && (bool)out;
+        }
+
+        bool Decompress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            LzFileHeader header;
+            if(!in.read((char*)&header,sizeof(header)) || memcmp(header.magic,HUF_LZ_MAGIC,4)!=0
+               || header.version!=HUF_LZ_VERSION || header.blockSize>MAX_BLOCK_SIZE){
+                return false;
+            }
+            stats.inputBytes+=sizeof(header);
+            while(true){
+                uint32_t rawLength;
+                if(!in.read((char*)&rawLength,sizeof(rawLength))){
+                    return false;
+                }
+                stats.inputBytes+=sizeof(rawLength);
+                if(rawLength==0){
+                    break;
+                }
+                uint32_t encodedLength;
+                // Blocks that would grow are stored
+                if(rawLength>header.blockSize || !in.read((char*)&encodedLength,sizeof(encodedLength))
+                   || encodedLength>4+(uint64_t)rawLength){
+                    return false;
+                }
+                encoded.resize(encodedLength);
+                raw.resize(rawLength);
+                if(!in.read((char*)encoded.data(),encodedLength)
+                   || !DecodeBlock(encoded.data(),encodedLength,raw.data(),rawLength)){
+                    return false;
+                }
+                out.write((const char*)raw.data(),rawLength);
+                stats.inputBytes+=sizeof(encodedLength)+encodedLength;
+                stats.outputBytes+=rawLength;
+                stats.blocks++;
+            }
+            return (bool)out;
+        }
+
+        bool CompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Compress(in,out);
+        }
+        bool DecompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Decompress(in,out);
+        }
+
+        const HuffmanStats& GetStats() const{
+            return stats;
+        }
+};
+
+#endif
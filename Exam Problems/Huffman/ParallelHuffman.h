@@ -0,0 +1,307 @@
+#ifndef PARALLELHUFFMAN_H
+#define PARALLELHUFFMAN_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include "HuffmanTree.h"
+#include "CanonicalCode.h"
+#include "LengthLimited.h"
+#include "BitStream.h"
+#include "HuffmanCodec.h"
+#include "../Common/ThreadPool.h"
+using namespace std;
+
+// Layout of a parallel stream: this header, then segments of
+//   uint32 rawLength, uint32 encodedLength, encodedLength bytes
+// ending with a rawLength of 0. A segment is cut into chunks of chunkSize
+// bytes (the last may be shorter) that share one code table but are
+// separate bitstreams, each starting on a byte boundary:
+//   uint16 numSymbols, per symbol uint8 symbol, uint8 length,
+//   uint32 chunkEnd[numChunks], the byte offset in the payload where each
+//   chunk stops, then the payload.
+// A numSymbols of 0 marks a stored segment followed by the raw bytes.
+struct ParallelFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint32_t segmentSize;
+    uint32_t chunkSize;
+};
+
+const char HUF_PARALLEL_MAGIC[4]={'H','U','F','P'};
+const uint32_t HUF_PARALLEL_VERSION=1;
+
+// Huffman coding on all cores. For each segment the threads count their
+// chunks' bytes, the per-chunk histograms are merged into one code table,
+// and since every chunk's exact encoded size follows from its histogram
+// the chunk index is known before any bit is written. Each thread then
+// encodes its chunks straight into place in the output. Decoding reads
+// the index and hands every chunk to a thread the same way. Memory is a
+// segment of input and one of output, whatever the file size.
+class ParallelHuffmanCodec{
+    private:
+        ThreadPool pool;
+        size_t segmentSize;
+        size_t chunkSize;
+        int maxCodeLength;
+        vector<uint8_t> raw;
+        vector<uint8_t> encoded;
+        vector<uint64_t> chunkCounts;
+        HuffmanStats stats;
+
+        int NumChunks(size_t length) const{
+            return (int)((length+chunkSize-1)/chunkSize);
+        }
+        size_t ChunkLength(size_t length, int c) const{
+            size_t begin=(size_t)c*chunkSize;
+            return length-begin<chunkSize ? length-begin : chunkSize;
+        }
+
+    public:
+        static const size_t DEFAULT_SEGMENT_SIZE=1<<24;
+        static const size_t DEFAULT_CHUNK_SIZE=1<<18;
+        static const size_t MAX_SEGMENT_SIZE=1<<30;
+
+        ParallelHuffmanCodec(int threads=(int)thread::hardware_concurrency(), size_t segment=DEFAULT_SEGMENT_SIZE, size_t chunk=DEFAULT_CHUNK_SIZE, int maxLength=MAX_CODE_LENGTH) : pool(threads){
+            maxCodeLength=maxLength;
+            segmentSize=segment<1 ? 1 : (segment>MAX_SEGMENT_SIZE ? MAX_SEGMENT_SIZE : segment);
+            chunkSize=chunk<1 ? 1 : (chunk>segmentSize ? segmentSize : chunk);
+        }
+
+        // Replaces out with data[0..length) as one encoded segment
+        void EncodeSegment(const uint8_t* data, size_t length, vector<uint8_t>& out){
+            int numChunks=NumChunks(length);
+            chunkCounts.assign((size_t)numChunks*256,0);
+            pool.ParallelFor(numChunks,[&](int, int begin, int end){
+                for(int c=begin;c<end;c++){
+                    CountBytes(data+(size_t)c*chunkSize,ChunkLength(length,c),chunkCounts.data()+(size_t)c*256);
+                }
+            });
+            uint64_t counts[256]={0};
+            for(int c=0;c<numChunks;c++){
+                for(int s=0;s<256;s++){
+                    counts[s]+=chunkCounts[(size_t)c*256+s];
+                }
+            }
+            int lengths[256];
+            LimitedCodeLengths(counts,lengths,maxCodeLength);
+            HuffmanCode codes[256];
+            bool coded=AssignCanonicalCodes(lengths,256,codes);
+
+            int numSymbols=0;
+            for(int s=0;s<256;s++){
+                numSymbols+=counts[s]>0 ? 1 : 0;
+            }
+            size_t indexAt=2+2*(size_t)numSymbols;
+            size_t payloadAt=indexAt+4*(size_t)numChunks;
+            vector<uint32_t> chunkEnd(numChunks);
+            uint64_t end=0;
+            for(int c=0;c<numChunks;c++){
+                uint64_t bits=0;
+                for(int s=0;s<256;s++){
+                    bits+=chunkCounts[(size_t)c*256+s]*lengths[s];
+                }
+                end+=(bits+7)/8;
+                chunkEnd[c]=(uint32_t)end;
+            }
+            // Lengths no canonical code can hold are stored raw as well
+            if(!coded || payloadAt+end>=2+length){
+                out.assign(2+length,0);
+                memcpy(out.data()+2,data,length);
+                return;
+            }
+            out.resize(payloadAt+end);
+            uint16_t n=(uint16_t)numSymbols;
+            memcpy(out.data(),&n,2);
+            size_t at=2;
+            for(int s=0;s<256;s++){
+                if(counts[s]>0){
+                    out[at]=(uint8_t)s;
+                    out[at+1]=(uint8_t)lengths[s];
+                    at+=2;
+                }
+            }
+            memcpy(out.data()+indexAt,chunkEnd.data(),4*(size_t)numChunks);
+
+            uint8_t* payload=out.data()+payloadAt;
+            pool.ParallelFor(numChunks,[&](int, int begin, int end){
+                for(int c=begin;c<end;c++){
+                    const uint8_t* chunk=data+(size_t)c*chunkSize;
+                    size_t n=ChunkLength(length,c);
+                    BitWriter writer(payload+(c>0 ? chunkEnd[c-1] : 0));
+                    for(size_t i=0;i<n;i++){
+                        const HuffmanCode& code=codes[chunk[i]];
+                        writer.Put(code.bits,code.length);
+                    }
+                    writer.Flush();
+                }
+            });
+        }
+
+        // Decodes one segment into out[0..rawLength); false if it is corrupt
+        bool DecodeSegment(const uint8_t* in, size_t inLength, uint8_t* out, size_t rawLength){
+            if(inLength<2){
+                return false;
+            }
+            uint16_t n;
+            memcpy(&n,in,2);
+            int numSymbols=n;
+            if(numSymbols==0){
+                if(inLength!=2+rawLength){
+                    return false;
+                }
+                memcpy(out,in+2,rawLength);
+                return true;
+            }
+            int numChunks=NumChunks(rawLength);
+            size_t indexAt=2+2*(size_t)numSymbols;
+            size_t payloadAt=indexAt+4*(size_t)numChunks;
+            if(numSymbols>256 || inLength<payloadAt){
+                return false;
+            }
+            int lengths[256]={0};
+            for(int k=0;k<numSymbols;k++){
+                int s=in[2+2*k];
+                int length=in[3+2*k];
+                if(length<1 || lengths[s]!=0){
+                    return false;
+                }
+                lengths[s]=length;
+            }
+            HuffmanDecoder decoder;
+            if(!decoder.Build(lengths,256)){
+                return false;
+            }
+            vector<uint32_t> chunkEnd(numChunks);
+            memcpy(chunkEnd.data(),in+indexAt,4*(size_t)numChunks);
+            uint32_t previous=0;
+            for(int c=0;c<numChunks;c++){
+                if(chunkEnd[c]<previous){
+                    return false;
+                }
+                previous=chunkEnd[c];
+            }
+            if(payloadAt+previous!=inLength){
+                return false;
+            }
+
+            const uint8_t* payload=in+payloadAt;
+            vector<char> chunkOk(numChunks,0);
+            pool.ParallelFor(numChunks,[&](int, int begin, int end){
+                for(int c=begin;c<end;c++){
+                    uint32_t from=c>0 ? chunkEnd[c-1] : 0;
+                    BitReader reader(payload+from,chunkEnd[c]-from);
+                    chunkOk[c]=decoder.DecodeSymbols(reader,out+(size_t)c*chunkSize,ChunkLength(rawLength,c))
+                               && !reader.Overrun();
+                }
+            });
+            for(char ok : chunkOk){
+                if(!ok){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool Compress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            ParallelFileHeader header;
+            memcpy(header.magic,HUF_PARALLEL_MAGIC,4);
+            header.version=HUF_PARALLEL_VERSION;
+            header.segmentSize=(uint32_t)segmentSize;
+            header.chunkSize=(uint32_t)chunkSize;
+            out.write((const char*)&header,sizeof(header));
+            stats.outputBytes+=sizeof(header);
+            stats.headerBytes+=sizeof(header);
+
+            raw.resize(segmentSize);
+            while(true){
+                in.read((char*)raw.data(),segmentSize);
+                size_t length=(size_t)in.gcount();
+                if(length==0){
+                    break;
+                }
+                EncodeSegment(raw.data(),length,encoded);
+                uint32_t frame[2]={(uint32_t)length,(uint32_t)encoded.size()};
+                out.write((const char*)frame,sizeof(frame));
+                out.write((const char*)encoded.data(),encoded.size());
+                uint16_t numSymbols;
+                memcpy(&numSymbols,encoded.data(),2);
+                stats.inputBytes+=length;
+                stats.outputBytes+=sizeof(frame)+encoded.size();
+                stats.headerBytes+=sizeof(frame)+2;
+                if(numSymbols>0){
+                    stats.headerBytes+=2*(size_t)numSymbols+4*(size_t)NumChunks(length);
+                }
+                stats.blocks++;
+            }
+            uint32_t end=0;
+            out.write((const char*)&end,sizeof(end));
+            stats.outputBytes+=sizeof(end);
+            stats.headerBytes+=sizeof(end);
+            return !in.bad() && (bool)out;
+        }
+
+        // Takes the chunk size from the stream, so any chunking decodes
+        bool Decompress(istream& in, ostream& out){
+            stats=HuffmanStats();
+            ParallelFileHeader header;
+            if(!in.read((char*)&header,sizeof(header)) || memcmp(header.magic,HUF_PARALLEL_MAGIC,4)!=0
+               || header.version!=HUF_PARALLEL_VERSION || header.segmentSize>MAX_SEGMENT_SIZE
+               || header.chunkSize<1 || header.chunkSize>header.segmentSize){
+                return false;
+            }
+            chunkSize=header.chunkSize;
+            stats.inputBytes+=sizeof(header);
+            while(true){
+                uint32_t rawLength;
+                if(!in.read((char*)&rawLength,sizeof(rawLength))){
+                    return false;
+                }
+                stats.inputBytes+=sizeof(rawLength);
+                if(rawLength==0){
+                    break;
+                }
+                uint32_t encodedLength;
+                if(rawLength>header.segmentSize || !in.read((char*)&encodedLength,sizeof(encodedLength))
+                   || encodedLength>2+2*256+4*(uint64_t)NumChunks(rawLength)+rawLength){
+                    return false;
+                }
+                encoded.resize(encodedLength);
+                raw.resize(rawLength);
+                if(!in.read((char*)encoded.data(),encodedLength)
+                   || !DecodeSegment(encoded.data(),encodedLength,raw.data(),rawLength)){
+                    return false;
+                }
+                out.write((const char*)raw.data(),rawLength);
+                stats.inputBytes+=sizeof(encodedLength)+encodedLength;
+                stats.outputBytes+=rawLength;
+                stats.blocks++;
+            }
+            return (bool)out;
+        }
+
+        bool CompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Compress(in,out);
+        }
+        bool DecompressFile(string inFile, string outFile){
+            ifstream in(inFile, ios::binary);
+            ofstream out(outFile, ios::binary);
+            return in.is_open() && out.is_open() && Decompress(in,out);
+        }
+
+        const HuffmanStats& GetStats() const{
+            return stats;
+        }
+        int GetNumThreads() const{
+            return pool.GetNumThreads();
+        }
+};
+
+#endif
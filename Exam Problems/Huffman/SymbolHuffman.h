@@ -0,0 +1,495 @@
+#ifndef SYMBOLHUFFMAN_H
+#define SYMBOLHUFFMAN_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "HuffmanTree.h"
+#include "CanonicalCode.h"
+#include "LengthLimited.h"
+#include "BitStream.h"
+using namespace std;
+
+// Huffman coding of symbols wider than a byte: 16-bit symbols, the
+// literal/length and distance codes of LZ77, or ids from alphabets too
+// large to count in an array. Symbol is an unsigned integer type and
+// every symbol is below ALPHABET_SIZE. The byte coders keep their own
+// stack-only tree and two-symbol decoder; this is the general version.
+
+// Counts in an array indexed by symbol, for alphabets up to 2^16
+template<class Symbol, uint64_t ALPHABET_SIZE>
+class DenseFrequencyTable{
+    private:
+        vector<uint64_t> counts;
+        vector<HuffmanCode> codes;
+    public:
+        DenseFrequencyTable() : counts(ALPHABET_SIZE,0), codes(ALPHABET_SIZE,HuffmanCode{0,0}){}
+
+        void Clear(){
+            fill(counts.begin(),counts.end(),0);
+        }
+        void Add(Symbol s){
+            counts[s]++;
+        }
+        // The symbols that occur, in increasing order, and their counts
+        void GetSymbols(vector<Symbol>& symbols, vector<uint64_t>& symbolCounts) const{
+            symbols.clear();
+            symbolCounts.clear();
+            for(uint64_t s=0;s<ALPHABET_SIZE;s++){
+                if(counts[s]>0){
+                    symbols.push_back((Symbol)s);
+                    symbolCounts.push_back(counts[s]);
+                }
+            }
+        }
+        void SetCode(Symbol s, HuffmanCode code){
+            codes[s]=code;
+        }
+        const HuffmanCode& GetCode(Symbol s) const{
+            return codes[s];
+        }
+};
+
+// Counts in an open-addressing hash table, for large sparse alphabets:
+// memory follows the symbols that occur, not the alphabet. A count of 0
+// marks an empty slot; the table doubles at half full.
+template<class Symbol, uint64_t ALPHABET_SIZE>
+class HashFrequencyTable{
+    private:
+        struct Slot{
+            Symbol symbol;
+            uint64_t count;
+            HuffmanCode code;
+        };
+        static const size_t INITIAL_SLOTS=64;
+        vector<Slot> slots;
+        size_t used=0;
+
+        static size_t Hash(Symbol s){
+            uint64_t h=(uint64_t)s*0x9E3779B97F4A7C15ull;
+            return (size_t)(h^(h>>32));
+        }
+        size_t Find(Symbol s) const{
+            size_t mask=slots.size()-1;
+            size_t i=Hash(s)&mask;
+            while(slots[i].count!=0 && slots[i].symbol!=s){
+                i=(i+1)&mask;
+            }
+            return i;
+        }
+        void Grow(){
+            vector<Slot> old;
+            old.swap(slots);
+            slots.assign(2*old.size(),Slot{0,0,{0,0}});
+            for(const Slot& slot : old){
+                if(slot.count!=0){
+                    slots[Find(slot.symbol)]=slot;
+                }
+            }
+        }
+    public:
+        HashFrequencyTable(){
+            Clear();
+        }
+
+        void Clear(){
+            slots.assign(INITIAL_SLOTS,Slot{0,0,{0,0}});
+            used=0;
+        }
+        void Add(Symbol s){
+            size_t i=Find(s);
+            if(slots[i].count==0){
+                if(2*(used+1)>slots.size()){
+                    Grow();
+                    i=Find(s);
+                }
+                slots[i].symbol=s;
+                used++;
+            }
+            slots[i].count++;
+        }
+        void GetSymbols(vector<Symbol>& symbols, vector<uint64_t>& symbolCounts) const{
+            vector<pair<Symbol,uint64_t>> found;
+            for(const Slot& slot : slots){
+                if(slot.count!=0){
+                    found.push_back({slot.symbol,slot.count});
+                }
+            }
+            sort(found.begin(),found.end());
+            symbols.clear();
+            symbolCounts.clear();
+            for(const auto& entry : found){
+                symbols.push_back(entry.first);
+                symbolCounts.push_back(entry.second);
+            }
+        }
+        // s must have been added
+        void SetCode(Symbol s, HuffmanCode code){
+            slots[Find(s)].code=code;
+        }
+        const HuffmanCode& GetCode(Symbol s) const{
+            return slots[Find(s)].code;
+        }
+};
+
+template<class Symbol, uint64_t ALPHABET_SIZE>
+using FrequencyTable=typename conditional<(ALPHABET_SIZE<=((uint64_t)1<<16)),
+                                          DenseFrequencyTable<Symbol,ALPHABET_SIZE>,
+                                          HashFrequencyTable<Symbol,ALPHABET_SIZE>>::type;
+
+// Code lengths for any number of counts, none above maxLength. The
+// linear two-queue merge over the sorted counts gives the optimal lengths;
+// if they are too long, package-merge over the same sorted order gives
+// the optimal limited ones. maxLength is raised to what the symbols need
+// and capped at MAX_CODE_LENGTH.
+inline void SymbolCodeLengths(const vector<uint64_t>& counts, vector<int>& lengths, int maxLength){
+    int n=(int)counts.size();
+    lengths.assign(n,0);
+    if(n<=1){
+        if(n==1){
+            lengths[0]=1;
+        }
+        return;
+    }
+    vector<int> order(n);
+    for(int i=0;i<n;i++){
+        order[i]=i;
+    }
+    sort(order.begin(),order.end(),[&](int a, int b){
+        return counts[a]!=counts[b] ? counts[a]<counts[b] : a<b;
+    });
+    // Nodes 0..n-1 are the sorted leaves, merged nodes follow in order
+    vector<uint64_t> weight(2*n-1);
+    vector<int> parent(2*n-1,-1);
+    for(int i=0;i<n;i++){
+        weight[i]=counts[order[i]];
+    }
+    int numNodes=n;
+    int nextLeaf=0;
+    int nextMerged=n;
+    auto takeSmallest=[&](){
+        if(nextLeaf<n && (nextMerged==numNodes || weight[nextLeaf]<=weight[nextMerged])){
+            return nextLeaf++;
+        }
+        return nextMerged++;
+    };
+    for(int merges=0;merges<n-1;merges++){
+        int left=takeSmallest();
+        int right=takeSmallest();
+        weight[numNodes]=weight[left]+weight[right];
+        parent[left]=parent[right]=numNodes;
+        numNodes++;
+    }
+    // Parents come after their children, so depths follow from the root down
+    vector<int> depth(numNodes,0);
+    int longest=0;
+    for(int i=numNodes-2;i>=0;i--){
+        depth[i]=depth[parent[i]]+1;
+        longest=i<n && depth[i]>longest ? depth[i] : longest;
+    }
+    maxLength=max(maxLength,MinCodeLength(n));
+    maxLength=min(maxLength,MAX_CODE_LENGTH);
+    if(longest<=maxLength){
+        for(int i=0;i<n;i++){
+            lengths[order[i]]=depth[i];
+        }
+        return;
+    }
+
+    // Package-merge as in PackageMergeLengths; items are leaf positions
+    const int PACKAGE=-1;
+    size_t width=2*(size_t)n;
+    vector<int> item((size_t)maxLength*width);
+    vector<int> size(maxLength);
+    vector<uint64_t> levelWeight[2]={vector<uint64_t>(width),vector<uint64_t>(width)};
+    for(int i=0;i<n;i++){
+        item[i]=i;
+        levelWeight[0][i]=weight[i];
+    }
+    size[0]=n;
+    for(int level=1;level<maxLength;level++){
+        const vector<uint64_t>& below=levelWeight[(level-1)&1];
+        vector<uint64_t>& current=levelWeight[level&1];
+        int* items=item.data()+(size_t)level*width;
+        int packages=size[level-1]/2;
+        int i=0;
+        int j=0;
+        int k=0;
+        while(i<n || j<packages){
+            uint64_t package=j<packages ? below[2*j]+below[2*j+1] : 0;
+            if(j>=packages || (i<n && weight[i]<=package)){
+                items[k]=i;
+                current[k++]=weight[i++];
+            }
+            else{
+                items[k]=PACKAGE;
+                current[k++]=package;
+                j++;
+            }
+        }
+        size[level]=k;
+    }
+    int selected=2*n-2;
+    for(int level=maxLength-1;level>=0;level--){
+        const int* items=item.data()+(size_t)level*width;
+        int packages=0;
+        for(int i=0;i<selected;i++){
+            if(items[i]==PACKAGE){
+                packages++;
+            }
+            else{
+                lengths[order[items[i]]]++;
+            }
+        }
+        selected=2*packages;
+    }
+}
+
+// Unsigned LEB128: seven bits a byte, low first, high bit set on all but
+// the last
+inline void PutVarint(vector<uint8_t>& out, uint64_t value){
+    while(value>=0x80){
+        out.push_back((uint8_t)(value|0x80));
+        value>>=7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+inline bool GetVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value){
+    value=0;
+    for(int shift=0;shift<64 && in<end;shift+=7){
+        uint8_t byte=*in++;
+        value|=(uint64_t)(byte&0x7F)<<shift;
+        if(byte<0x80){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Counts symbols and builds a canonical code for them. The code table is
+// stored as a varint count of symbols, then per symbol in increasing
+// order the varint gap from the previous one (the first: its value) and
+// a byte with its length. Sparse alphabets thus cost what they use.
+template<class Symbol, uint64_t ALPHABET_SIZE>
+class SymbolEncoder{
+    private:
+        static_assert(is_unsigned<Symbol>::value, "symbols are unsigned integers");
+        FrequencyTable<Symbol,ALPHABET_SIZE> table;
+        vector<Symbol> symbols;
+        vector<uint64_t> counts;
+        vector<int> lengths;
+    public:
+        void Clear(){
+            table.Clear();
+            symbols.clear();
+            counts.clear();
+            lengths.clear();
+        }
+        void Add(Symbol s){
+            table.Add(s);
+        }
+        // Codes for the symbols added so far, none longer than maxLength
+        void Build(int maxLength=MAX_CODE_LENGTH){
+            table.GetSymbols(symbols,counts);
+            SymbolCodeLengths(counts,lengths,maxLength);
+            vector<HuffmanCode> codes(symbols.size());
+            AssignCanonicalCodes(lengths.data(),(int)symbols.size(),codes.data());
+            for(size_t i=0;i<symbols.size();i++){
+                table.SetCode(symbols[i],codes[i]);
+            }
+        }
+        // Payload bits of the symbols added, after Build
+        uint64_t PayloadBits() const{
+            uint64_t bits=0;
+            for(size_t i=0;i<symbols.size();i++){
+                bits+=counts[i]*lengths[i];
+            }
+            return bits;
+        }
+        void WriteTable(vector<uint8_t>& out) const{
+            PutVarint(out,symbols.size());
+            uint64_t previous=0;
+            for(size_t i=0;i<symbols.size();i++){
+                PutVarint(out,(uint64_t)symbols[i]-previous);
+                out.push_back((uint8_t)lengths[i]);
+                previous=symbols[i];
+            }
+        }
+        int GetNumSymbols() const{
+            return (int)symbols.size();
+        }
+        // s must have been added before Build
+        void Put(Symbol s, BitWriter& writer) const{
+            const HuffmanCode& code=table.GetCode(s);
+            writer.Put(code.bits,code.length);
+        }
+};
+
+// Table-driven canonical decoder for SymbolEncoder's codes. One lookup on
+// the next TABLE_BITS bits gives a short code's rank in canonical order
+// and its length; longer codes go through the first code of each length
+// as in HuffmanDecoder. One symbol per lookup, since symbols do not fit
+// two to an entry.
+template<class Symbol, uint64_t ALPHABET_SIZE>
+class SymbolDecoder{
+    private:
+        static const int TABLE_BITS=11;
+        // rank | length<<27; a length of 0 sends the lookup to the long path
+        vector<uint32_t> table;
+        int maxLength=0;
+        uint32_t firstCode[MAX_CODE_LENGTH+1];
+        int count[MAX_CODE_LENGTH+1];
+        int offset[MAX_CODE_LENGTH+1];
+        vector<Symbol> sorted;
+
+        bool DecodeLong(BitReader& reader, Symbol& symbol) const{
+            for(int length=TABLE_BITS+1;length<=maxLength;length++){
+                uint32_t code=reader.Peek(length);
+                if(code-firstCode[length]<(uint32_t)count[length]){
+                    reader.Skip(length);
+                    symbol=sorted[offset[length]+(code-firstCode[length])];
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // symbols in increasing order; false if the lengths are no prefix code
+        bool Build(const vector<Symbol>& symbols, const vector<int>& lengths){
+            int n=(int)symbols.size();
+            vector<HuffmanCode> codes(n);
+            if(n>=(1<<27) || !AssignCanonicalCodes(lengths.data(),n,codes.data())){
+                return false;
+            }
+            maxLength=0;
+            for(int length=0;length<=MAX_CODE_LENGTH;length++){
+                count[length]=0;
+                firstCode[length]=0;
+            }
+            for(int i=0;i<n;i++){
+                count[lengths[i]]++;
+                maxLength=lengths[i]>maxLength ? lengths[i] : maxLength;
+            }
+            int at=0;
+            for(int length=1;length<=MAX_CODE_LENGTH;length++){
+                offset[length]=at;
+                at+=count[length];
+            }
+            sorted.assign(at,0);
+            table.assign((size_t)1<<TABLE_BITS,0);
+            vector<int> fill(offset,offset+MAX_CODE_LENGTH+1);
+            for(int i=0;i<n;i++){
+                int length=lengths[i];
+                int rank=fill[length]++;
+                if(rank==offset[length]){
+                    firstCode[length]=codes[i].bits;
+                }
+                sorted[rank]=symbols[i];
+                if(length<=TABLE_BITS){
+                    uint32_t first=codes[i].bits<<(TABLE_BITS-length);
+                    uint32_t last=(codes[i].bits+1)<<(TABLE_BITS-length);
+                    for(uint32_t k=first;k<last;k++){
+                        table[k]=(uint32_t)rank|((uint32_t)length<<27);
+                    }
+                }
+            }
+            return true;
+        }
+
+    public:
+        // Reads a table written by SymbolEncoder and advances in past it.
+        // False if it is corrupt or has a code longer than maxAllowed.
+        bool ReadTable(const uint8_t*& in, const uint8_t* end, int maxAllowed=MAX_CODE_LENGTH){
+            uint64_t n;
+            if(!GetVarint(in,end,n) || n>ALPHABET_SIZE || n>(uint64_t)(end-in)/2){
+                return false;
+            }
+            vector<Symbol> symbols(n);
+            vector<int> lengths(n);
+            uint64_t previous=0;
+            for(uint64_t i=0;i<n;i++){
+                uint64_t gap;
+                if(!GetVarint(in,end,gap) || in==end || (i>0 && gap==0) || gap>=ALPHABET_SIZE-previous){
+                    return false;
+                }
+                previous+=gap;
+                symbols[i]=(Symbol)previous;
+                lengths[i]=*in++;
+                if(lengths[i]<1 || lengths[i]>maxAllowed){
+                    return false;
+                }
+            }
+            return Build(symbols,lengths);
+        }
+
+        int GetMaxLength() const{
+            return maxLength;
+        }
+
+        // The next symbol, after a Refill; false if the bits are no code
+        bool Decode(BitReader& reader, Symbol& symbol) const{
+            uint32_t entry=table[reader.Peek(TABLE_BITS)];
+            if(entry>>27){
+                reader.Skip(entry>>27);
+                symbol=sorted[entry&((1u<<27)-1)];
+                return true;
+            }
+            return DecodeLong(reader,symbol);
+        }
+
+        // Decodes count symbols into out; false if the bits are no code
+        bool DecodeSymbols(BitReader& reader, Symbol* out, size_t count) const{
+            BitReader local=reader;
+            int need=maxLength>TABLE_BITS ? maxLength : TABLE_BITS;
+            size_t i=0;
+            while(i<count){
+                local.Refill();
+                do{
+                    if(!Decode(local,out[i++])){
+                        return false;
+                    }
+                } while(i<count && local.Available()>=need);
+            }
+            reader=local;
+            return true;
+        }
+};
+
+// Whole blocks of symbols: the code table, then the payload
+template<class Symbol, uint64_t ALPHABET_SIZE>
+class SymbolHuffmanCodec{
+    public:
+        // Replaces out with data[0..length) as one block; length at least 1
+        static void EncodeBlock(const Symbol* data, size_t length, vector<uint8_t>& out, int maxLength=MAX_CODE_LENGTH){
+            SymbolEncoder<Symbol,ALPHABET_SIZE> encoder;
+            for(size_t i=0;i<length;i++){
+                encoder.Add(data[i]);
+            }
+            encoder.Build(maxLength);
+            out.clear();
+            encoder.WriteTable(out);
+            size_t tableBytes=out.size();
+            out.resize(tableBytes+(size_t)((encoder.PayloadBits()+7)/8));
+            BitWriter writer(out.data()+tableBytes);
+            for(size_t i=0;i<length;i++){
+                encoder.Put(data[i],writer);
+            }
+            writer.Flush();
+        }
+
+        // Decodes one block of count symbols into out; false if it is corrupt
+        static bool DecodeBlock(const uint8_t* in, size_t inLength, Symbol* out, size_t count){
+            const uint8_t* end=in+inLength;
+            SymbolDecoder<Symbol,ALPHABET_SIZE> decoder;
+            if(!decoder.ReadTable(in,end)){
+                return false;
+            }
+            BitReader reader(in,end-in);
+            return decoder.DecodeSymbols(reader,out,count) && !reader.Overrun();
+        }
+};
+
+#endif